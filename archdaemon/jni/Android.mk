@@ -5,13 +5,26 @@ LOCAL_MODULE := sys.azenith-service
 LOCAL_SRC_FILES := \
     main.c \
     src/cmd_utils.c \
+    src/shell_pool.c \
+    src/profile_worker.c \
+    src/timer_wheel.c \
+    src/exec_stats.c \
     src/azenith_log.c \
+    src/log_ingest.c \
+    src/binlog.c \
+    src/prop_cache.c \
+    src/prop_set.c \
     src/azenith_profiler.c \
     src/file_utils.c \
     src/process_utils.c \
+    src/proc_events.c \
     src/misc_utils.c \
+    src/notify_dispatch.c \
+    src/control_socket.c \
     src/game_preload.c \
     src/main_loop.c \
+    src/gamelist_parser.c \
+    src/gamelist_cache.c \
     src/azenith_commandline.c \
     src/bypass_charge.c \
     src/app_status_monitor.c \
@@ -26,6 +39,6 @@ LOCAL_CFLAGS := -DNDEBUG -Wall -Wextra -Werror \
                 -O2 -std=c23 -fPIC -flto
 
 LOCAL_LDFLAGS := -flto
-LOCAL_LDLIBS  += -llog  
+LOCAL_LDLIBS  += -llog -ldl
 
 include $(BUILD_EXECUTABLE)
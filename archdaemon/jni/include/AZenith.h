@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <pthread.h> // FIX: Ditambahkan untuk pthread_mutex_t
 
 #define TASK_INTERVAL_SEC (12 * 60 * 60)
@@ -41,13 +42,34 @@
 #define LOOP_INTERVAL_SEC 1
 #define MAX_DATA_LENGTH 1024
 #define MAX_COMMAND_LENGTH 600
-#define MAX_OUTPUT_LENGTH 256
 #define MAX_PATH_LENGTH 256
 #define MAX_LINE 512
 #define MAX_PACKAGE 128
 
 #define MAX_GAME_PIDS 8
 
+#define SHELL_POOL_SIZE 2
+#define SHELL_POOL_MAX_WORKERS 4
+#define SHELL_POOL_UNAVAILABLE (-2)
+#define EXEC_TIMED_OUT (-3)
+#define CONTROL_UNREACHABLE (-1)
+#define CONTROL_NO_ANSWER (-2)
+#define EXEC_TIMEOUT_MS 20000
+#define EXEC_PRELOAD_TIMEOUT_MS 120000
+#define NOTIFY_BROADCAST_TIMEOUT_MS 5000
+#define PROFILE_RETRY_DELAY_MS 2000
+#define PROFILE_APPLY_RETRIES 3
+#define SPAWN_RETRY_DELAY_MS 100
+#define SPAWN_RETRY_MAX_DELAY_MS 800
+#define SPAWN_RETRIES 5
+#define TIMER_WHEEL_SLOTS 256
+#define TIMER_TICK_MS 10
+#define GRACE_PERIOD_MS 10000
+#define PRELOAD_DELAY_MS 5000
+#define RENDERER_RESTART_DELAY_MS 200
+#define RENDERER_RESPAWN_WAIT_MS 500
+#define GAMELIST_SETTLE_MS 50
+
 #define NOTIFY_TITLE "AZenith"
 #define LOG_TAG "AZenith"
 
@@ -55,11 +77,13 @@
 #define LOG_FILE "/data/adb/.config/AZenith/debug/AZenith.log"
 #define LOG_VFILE "/data/adb/.config/AZenith/debug/AZenithVerbose.log"
 #define LOG_FILE_PRELOAD "/data/adb/.config/AZenith/preload/AZenithPR.log"
+#define BINLOG_FILE "/data/adb/.config/AZenith/debug/AZenith.binlog"
 #define PROFILE_MODE "/data/adb/.config/AZenith/API/current_profile"
 #define PROFILE_MODE_APP "/data/data/zx.azenith/API/current_profile"
 #define GAME_INFO "/data/adb/.config/AZenith/API/gameinfo"
 #define GAME_INFO_APP "/data/data/zx.azenith/API/gameinfo"
 #define GAMELIST "/data/adb/.config/AZenith/gamelist/azenithApplist.json"
+#define GAMELIST_CACHE "/data/adb/.config/AZenith/gamelist/azenithApplist.bin"
 #define DAEMON_MODES "/data/adb/.config/AZenith/API/current_modes"
 #define MODULE_PROP "/data/adb/modules/AZenith/module.prop"
 #define MODULE_UPDATE "/data/adb/modules/AZenith/update"
@@ -67,6 +91,8 @@
 #define BYPASSCHG_CONFIG "/data/adb/.config/AZenith/bypasschgconfig"
 #define MODULE_VERSION ".placeholder"
 #define APP_MONITOR_FILE "/data/adb/.config/AZenith/app_status"
+#define APP_STATE_FILE "/data/adb/.config/AZenith/app_state"
+#define APP_STATE_WAKE APP_STATE_FILE ".wake"
 
 #define IS_TRUE(v)    ((v) && strcmp((v), "true") == 0)
 #define IS_FALSE(v)   ((v) && strcmp((v), "false") == 0)
@@ -98,10 +124,19 @@ typedef struct {
     char renderer[64];
 } GameConfig;
 
-// FIX: Gunakan extern agar variabel ini menjadi Global Shared di semua file .c
-extern GameConfig* g_game_cache;
-extern int g_game_cache_count;
-extern pthread_mutex_t cache_mutex;
+/**
+ * @struct GameList
+ * @brief One immutable generation of the parsed gamelist and its package index.
+ * @note When map is set, games and index point into the read-only compiled gamelist mapping.
+ */
+typedef struct {
+    const GameConfig* games;
+    int count;
+    const uint32_t* index;
+    uint32_t index_mask;
+    void* map;
+    size_t map_len;
+} GameList;
 
 /**
  * @struct SystemStateCache
@@ -111,6 +146,7 @@ typedef struct {
     char focused_app[128];
     char app_name[256];
     int focused_pid;
+    int focused_uid;
     int zen_mode;
     int screen_awake;
     int battery_saver;
@@ -118,6 +154,64 @@ typedef struct {
     int is_charging;
 } SystemStateCache;
 
+/**
+ * @struct NotifyMessage
+ * @brief A toast and/or notification broadcast queued for the dispatcher thread.
+ */
+typedef struct {
+    char toast[256];
+    char title[128];
+    char text[512];
+    bool has_toast;
+    bool has_notify;
+    bool chrono;
+    int timeout_ms;
+    unsigned int transition;
+} NotifyMessage;
+
+#define APP_STATE_MAGIC 0x54535A41u /* "AZST" little-endian */
+#define APP_STATE_VERSION 1
+#define APP_STATE_SIZE 4096
+
+/**
+ * @struct AppStateBlock
+ * @brief Fixed-layout state block shared with the Java companion through an mmap'd file.
+ * @note The companion bumps seq to odd before writing and back to even after (seqlock). All
+ * fields are little-endian; keep this layout in sync with AppMonitor.kt.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;
+    uint32_t reserved;
+    int32_t focused_pid;
+    int32_t focused_uid;
+    int32_t screen_awake;
+    int32_t battery_saver;
+    int32_t zen_mode;
+    int32_t battery_level;
+    int32_t is_charging;
+    int32_t refresh_rate;
+    int32_t max_refresh_rate;
+    int32_t reserved2;
+    char focused_app[128];
+    char app_name[256];
+} AppStateBlock;
+
+/**
+ * @brief System properties served from the property cache.
+ */
+typedef enum : char {
+    PROP_DEBUGMODE,
+    PROP_IOSCHED,
+    PROP_CPULIMIT,
+    PROP_DND,
+    PROP_APRELOAD,
+    PROP_PRELOADBUDGET,
+    PROP_SHOWTOAST,
+    PROP_COUNT
+} CachedProp;
+
 typedef enum : char {
     LOG_DEBUG,
     LOG_INFO,
@@ -126,6 +220,96 @@ typedef enum : char {
     LOG_FATAL
 } LogLevel;
 
+/**
+ * @brief Log file a message is routed to.
+ */
+typedef enum : char {
+    LOG_DEST_MAIN,
+    LOG_DEST_VERBOSE,
+    LOG_DEST_PRELOAD,
+    LOG_DEST_COUNT
+} LogDest;
+
+/**
+ * @brief Commands the CLI sends to the running daemon over the control socket.
+ * @note Logging never goes through here, helpers log while the main thread waits for them.
+ */
+typedef enum : char {
+    CTL_PROFILE = 1,
+    CTL_STATUS,
+    CTL_RELOAD,
+    CTL_STATS
+} ControlCommand;
+
+/**
+ * @struct ControlRequest
+ * @brief One CLI request, sent as a single SOCK_SEQPACKET message.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t command;
+    int32_t arg;
+} ControlRequest;
+
+/**
+ * @struct ControlResponse
+ * @brief The daemon's answer, sent once the request has been carried out.
+ * @note Replies longer than one message come as lines with more set, followed by the final answer.
+ */
+typedef struct {
+    int32_t status;
+    uint32_t more;
+    char text[512];
+} ControlResponse;
+
+/**
+ * @brief How an external command was started, tracked by the exec statistics.
+ */
+typedef enum : char {
+    EXEC_POOL,
+    EXEC_FORK,
+    EXEC_DIRECT,
+    EXEC_STREAM,
+    EXEC_WORKER,
+    EXEC_PATH_COUNT
+} ExecPath;
+
+/**
+ * @struct Timer
+ * @brief A one-shot timer on the daemon's timer wheel, owned and embedded by the caller.
+ * @note fn runs on the main thread once the timer expires. A timer without fn only wakes the
+ * main loop.
+ */
+typedef struct Timer {
+    struct Timer* next;
+    struct Timer** pprev;
+    uint64_t expires;
+    void (*fn)(void* arg);
+    void* arg;
+} Timer;
+
+/**
+ * @struct RetryPolicy
+ * @brief Declares how an operation is retried: first delay, growth factor, cap and attempt limit.
+ */
+typedef struct {
+    uint32_t delay_ms;
+    uint32_t max_delay_ms;
+    uint8_t backoff;
+    uint8_t max_attempts;
+} RetryPolicy;
+
+/**
+ * @struct RetryTimer
+ * @brief A timer that schedules the attempts of a RetryPolicy.
+ */
+typedef struct {
+    Timer timer;
+    const RetryPolicy* policy;
+    int attempt;
+} RetryTimer;
+
 typedef enum : char {
     PERFCOMMON,
     PERFORMANCE_PROFILE,
@@ -133,6 +317,39 @@ typedef enum : char {
     ECO_MODE
 } ProfileMode;
 
+/**
+ * @brief States of the main loop's profile state machine.
+ * @note LAUNCHING covers a focused game whose renderer switch or PIDs are still pending, GRACE a
+ * game that keeps Performance for GRACE_PERIOD_MS after the screen went off.
+ */
+typedef enum : char {
+    STATE_BOOT,
+    STATE_BALANCED,
+    STATE_ECO,
+    STATE_LAUNCHING,
+    STATE_PERFORMANCE,
+    STATE_GRACE,
+    STATE_MANUAL,
+    STATE_COUNT
+} DaemonState;
+
+/**
+ * @brief Typed events the main loop routes through its transition table.
+ * @note Pending events are kept as a bitmask, so duplicates coalesce and arrival order is lost.
+ * The order here is their priority: dispatch_events() handles them from the first to the last
+ * within one wakeup, whatever order they were posted in.
+ */
+typedef enum : char {
+    EVENT_AUTO_MODE,
+    EVENT_SCREEN_OFF,
+    EVENT_SCREEN_ON,
+    EVENT_GAME_GONE,
+    EVENT_APP_STATE,
+    EVENT_GRACE_EXPIRED,
+    EVENT_SPAWN_CHECK,
+    EVENT_COUNT
+} DaemonEvent;
+
 typedef struct {
     const char* name;
     const char* path;
@@ -143,6 +360,7 @@ typedef struct {
 extern BypassNode bypass_list[]; 
 extern char* gamestart;
 extern char* custom_log_tag;
+extern const char* level_str[];
 
 extern pid_t game_pids[MAX_GAME_PIDS];
 extern int game_pid_count;
@@ -150,9 +368,22 @@ extern int game_pid_count;
 // Main Loop
 int main_daemon(void);
 void free_gamelist_cache(void);
+const GameList* gamelist_acquire(unsigned int* ticket);
+void gamelist_release(unsigned int ticket);
+
+// Gamelist Parser
+int parse_gamelist(const char* json, size_t len, GameConfig** out);
+uint32_t* build_gamelist_index(const GameConfig* games, int count, uint32_t* mask);
+int find_game_index(const GameConfig* games, const uint32_t* index, uint32_t mask, const char* package);
+int handle_bench_gamelist(int argc, char** argv);
+
+// Gamelist Cache
+GameList* load_gamelist(int fd, const struct stat* st);
+void free_gamelist(GameList* list);
 
 // Bypass Charging
 int echo_to_file(const char* path, const char* value, int lock);
+int select_bypass_node(const char* name);
 int is_charging();
 int read_current_ma();
 void disable_bypass();
@@ -169,6 +400,10 @@ int require_daemon_running(void);
 int handle_profile(int argc, char** argv);
 int handle_log(int argc, char** argv);
 int handle_verboselog(int argc, char** argv);
+int handle_status(void);
+int handle_reload(void);
+int handle_stats(int argc, char** argv);
+int handle_logdump(int argc, char** argv);
 
 // Misc Utilities
 extern void GamePreload(const char* package);
@@ -176,6 +411,11 @@ void sighandler(const int signal);
 char* trim_newline(char* string);
 void notify(const char* title, const char* fmt, bool chrono, int timeout_ms, ...);
 void toast(const char* message);
+void notify_dispatch_start(void);
+void notify_dispatch_stop(void);
+void notify_dispatch_post(NotifyMessage* msg);
+void notify_begin_transition(void);
+void notify_end_transition(void);
 void is_kanged(void);
 void checkstate(void);
 void escape_shell_string(char *dest, const char *src, size_t max_size);
@@ -187,12 +427,47 @@ void runthermalcore(void);
 void check_module_version(void);
 void apply_dynamic_refresh_rate(int target_rr);
 int get_max_refresh_rate(void);
-bool apply_smart_renderer(const char* target_type, const char* pkg, char* saved_ref);
+bool apply_smart_renderer(const char* target_type, char* saved_ref);
+void restart_app(const char* pkg);
 
 // Shell and Command execution
 char* execute_command(const char* format, ...);
+char* execute_command_timeout(int timeout_ms, const char* format, ...);
 char* execute_direct(const char* path, const char* arg0, ...);
+int exec_stream(int timeout_ms, void (*on_line)(char* line, void* arg), void* arg, const char* format, ...);
 int systemv(const char* format, ...);
+int systemv_timeout(int timeout_ms, const char* format, ...);
+pid_t exec_spawn(const char* path, char* const argv[], char* const envp[], const int fds[3]);
+void exec_cancel_all(void);
+
+// Exec statistics
+uint64_t exec_clock_ns(void);
+void exec_stats_record(const char* command, ExecPath path, uint64_t spawn_ns, uint64_t wait_ns, bool failed);
+void exec_stats_report(int client, bool reset);
+
+// Timer wheel
+int timer_wheel_open(void);
+int timer_wheel_timeout(void);
+void timer_wheel_dispatch(void);
+void timer_wheel_close(void);
+void timer_init(Timer* timer, void (*fn)(void* arg), void* arg);
+void timer_schedule(Timer* timer, uint32_t delay_ms);
+void timer_cancel(Timer* timer);
+bool timer_pending(const Timer* timer);
+void retry_init(RetryTimer* retry, const RetryPolicy* policy, void (*fn)(void* arg), void* arg);
+int retry_schedule(RetryTimer* retry);
+void retry_reset(RetryTimer* retry);
+
+// Shell Pool
+int shell_pool_init(int size);
+int shell_pool_run(const char* command, char** output, int timeout_ms);
+void shell_pool_log_stats(void);
+void shell_pool_stats_report(int client, bool reset);
+void shell_pool_shutdown(void);
+
+// Profile settings worker
+int run_profilesettings(const char* command);
+void profile_worker_shutdown(void);
 
 // Utilities
 int check_running_state(void);
@@ -206,10 +481,42 @@ void log_verbose(LogLevel level, const char* message, ...);
 void log_zenith(LogLevel level, const char* message, ...);
 void external_log(LogLevel level, const char* tag, const char* message);
 void external_vlog(LogLevel level, const char* tag, const char* message);
+void log_writer_start(void);
+void log_writer_flush(void);
+void log_writer_stop(void);
+void log_ingest_start(void);
+bool binlog_open(void);
+bool binlog_active(void);
+void binlog_record(LogDest dest, LogLevel level, const char* tag, const char* fmt, va_list args);
+
+// Property cache
+int prop_cache_get(CachedProp id, char* value);
+bool prop_cache_equals(CachedProp id, const char* expected);
+const char* prop_cache_name(CachedProp id);
+int prop_cache_watch_start(void);
+uint32_t prop_cache_take_changes(int fd);
+int prop_set(const char* name, const char* value);
+uint32_t prop_set_count(void);
+
+// Control socket
+int control_socket_open(void);
+int control_socket_accept(int listen_fd, ControlRequest* req);
+void control_socket_send(int client, const char* fmt, ...);
+void control_socket_reply(int client, int status, const char* fmt, ...);
+int control_request(ControlRequest* req, ControlResponse* resp);
 
 // Utilities
 void set_priority(const pid_t pid);
 int uidof(pid_t pid);
+int rebuild_process_table(void);
+int process_table_size(void);
+int pidfd_of(pid_t pid);
+
+// Process Events
+int proc_events_open(void);
+void proc_events_set_active(int fd, bool active);
+int proc_events_handle(int fd, const char* package, int target_uid, pid_t* pids, int count, int max_pids);
+int proc_events_find_recent(int uid, pid_t* pids, int max_pids);
 
 // App Monitor
 char* get_visible_package(SystemStateCache* cache);
@@ -222,9 +529,13 @@ extern bool (*get_low_power_state)(SystemStateCache*);
 char* get_gamestart(GameConfig* options, SystemStateCache* cache);
 bool get_screenstate_normal(SystemStateCache* cache);
 bool get_low_power_state_normal(SystemStateCache* cache);
-void run_profiler(const int profile);
+int run_profiler(const int profile);
 char* skip_space(char* p);
+uint32_t fnv1a_hash(const char* s);
 void read_app_status(SystemStateCache* cache);
-void extract_string_value(char* dest, const char* start, size_t max_len);
+int app_state_channel_open(void);
+bool app_state_channel_active(void);
+void app_state_channel_drain(int wake_fd);
+bool app_state_read_refresh_rates(int* current_rr, int* max_rr);
 
 #endif
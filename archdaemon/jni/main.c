@@ -53,6 +53,16 @@ int main(int argc, char* argv[]) {
         print_bypass_path_list();
         return 0;
     }
+    if (IS_CMD(cmd, "--benchgamelist", "-bgl"))
+        return handle_bench_gamelist(argc, argv);
+    if (IS_CMD(cmd, "--logdump", "-ld"))
+        return handle_logdump(argc, argv);
+
+    /* Logging works without the daemon, helpers flush their buffered lines here when it is absent */
+    if (IS_CMD(cmd, "--log", "-l"))
+        return handle_log(argc, argv);
+    if (IS_CMD(cmd, "--verboselog", "-vl"))
+        return handle_verboselog(argc, argv);
 
     if (!require_daemon_running()) {
         return 1;
@@ -60,10 +70,12 @@ int main(int argc, char* argv[]) {
 
     if (IS_CMD(cmd, "--profile", "-p"))
         return handle_profile(argc, argv);
-    if (IS_CMD(cmd, "--log", "-l"))
-        return handle_log(argc, argv);
-    if (IS_CMD(cmd, "--verboselog", "-vl"))
-        return handle_verboselog(argc, argv);
+    if (IS_CMD(cmd, "--status", "-s"))
+        return handle_status();
+    if (IS_CMD(cmd, "--reload", "-rl"))
+        return handle_reload();
+    if (IS_CMD(cmd, "--stats", "-st"))
+        return handle_stats(argc, argv);
     if (IS_CMD(cmd, "--checkbypasschg", "-cbc"))
         return check_bypass_compatibility();
 
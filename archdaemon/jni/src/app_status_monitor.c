@@ -15,16 +15,164 @@
  */
 
 #include <AZenith.h>
+#include <stddef.h>
 #include <string.h>
+#include <sys/mman.h>
+
+#define APP_STATE_MAX_RETRIES 64
+
+_Static_assert(offsetof(AppStateBlock, focused_pid) == 16, "AppStateBlock layout changed");
+_Static_assert(offsetof(AppStateBlock, focused_app) == 56, "AppStateBlock layout changed");
+_Static_assert(offsetof(AppStateBlock, app_name) == 184, "AppStateBlock layout changed");
+_Static_assert(sizeof(AppStateBlock) <= APP_STATE_SIZE, "AppStateBlock exceeds mapping");
+
+static const volatile AppStateBlock* state_block = NULL;
+
+/**
+ * @brief Maps the companion state block read-only and creates the wake FIFO it rings after
+ * each update.
+ * @note Falls back to the app_status text file when the block is missing or has an unknown
+ * version (older companion). Safe to retry while it fails, the companion writes app_status
+ * until the wake FIFO has a reader.
+ * @return Read end of the wake FIFO to add to the poll set, or -1 if the channel is unavailable.
+ */
+int app_state_channel_open(void) {
+    int fd = open(APP_STATE_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < APP_STATE_SIZE) {
+        close(fd);
+        return -1;
+    }
+
+    void* map = mmap(NULL, APP_STATE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return -1;
+
+    const AppStateBlock* block = map;
+    if (block->magic != APP_STATE_MAGIC || block->version != APP_STATE_VERSION) {
+        static bool warned = false;
+        if (!warned) {
+            log_zenith(LOG_WARN, "App state block has unknown format, using app_status file");
+            warned = true;
+        }
+        munmap(map, APP_STATE_SIZE);
+        return -1;
+    }
+
+    struct stat wst;
+    if (stat(APP_STATE_WAKE, &wst) == 0 && !S_ISFIFO(wst.st_mode))
+        unlink(APP_STATE_WAKE);
+    if (mkfifo(APP_STATE_WAKE, 0600) != 0 && errno != EEXIST) {
+        munmap(map, APP_STATE_SIZE);
+        return -1;
+    }
+
+    int wake_fd = open(APP_STATE_WAKE, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (wake_fd < 0) {
+        munmap(map, APP_STATE_SIZE);
+        return -1;
+    }
+
+    /* Hold a writer ourselves so the FIFO never reports POLLHUP when the companion reconnects */
+    open(APP_STATE_WAKE, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+    state_block = block;
+    log_zenith(LOG_INFO, "Using shared app state channel (version %d)", APP_STATE_VERSION);
+    return wake_fd;
+}
+
+/**
+ * @brief Checks whether app state is read from the shared block instead of the text file.
+ * @return true if the shared state channel is mapped.
+ */
+bool app_state_channel_active(void) {
+    return state_block != NULL;
+}
 
 /**
- * @brief Reads the app status file and populates the SystemStateCache.
+ * @brief Consumes pending wake bytes so the FIFO stops polling readable.
+ * @param wake_fd Read end returned by app_state_channel_open().
+ */
+void app_state_channel_drain(int wake_fd) {
+    char buf[64];
+    while (read(wake_fd, buf, sizeof(buf)) > 0)
+        ;
+}
+
+/**
+ * @brief Takes a consistent snapshot of the shared state block under its seqlock.
+ * @param out Destination for the snapshot.
+ * @return true if a consistent snapshot was taken, false if the writer kept it busy.
+ */
+static bool snapshot_state_block(AppStateBlock* out) {
+    for (int i = 0; i < APP_STATE_MAX_RETRIES; i++) {
+        uint32_t seq1 = __atomic_load_n(&state_block->seq, __ATOMIC_ACQUIRE);
+        if (seq1 & 1)
+            continue;
+
+        memcpy(out, (const void*)state_block, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&state_block->seq, __ATOMIC_RELAXED) == seq1) {
+            out->focused_app[sizeof(out->focused_app) - 1] = '\0';
+            out->app_name[sizeof(out->app_name) - 1] = '\0';
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reads the current and maximum refresh rate from the shared state block.
+ * @param current_rr Destination for the current refresh rate, may be NULL.
+ * @param max_rr Destination for the maximum refresh rate, may be NULL.
+ * @return true if the values came from the shared block, false if the caller must use the file.
+ */
+bool app_state_read_refresh_rates(int* current_rr, int* max_rr) {
+    AppStateBlock snap;
+    if (!state_block || !snapshot_state_block(&snap))
+        return false;
+
+    if (current_rr)
+        *current_rr = snap.refresh_rate;
+    if (max_rr)
+        *max_rr = snap.max_refresh_rate;
+    return true;
+}
+
+/**
+ * @brief Reads the app status and populates the SystemStateCache.
+ * @note Reads the shared state block without syscalls when available, else parses the text file.
  * @param cache Pointer to the SystemStateCache structure.
  */
 void read_app_status(SystemStateCache* cache) {
     if (!cache)
         return;
 
+    if (state_block) {
+        AppStateBlock snap;
+        if (!snapshot_state_block(&snap)) {
+            log_verbose(LOG_WARN, "App state block busy, keeping previous state");
+            return;
+        }
+
+        memcpy(cache->focused_app, snap.focused_app, sizeof(cache->focused_app));
+        strncpy(cache->app_name, snap.app_name[0] ? snap.app_name : "Unknown", sizeof(cache->app_name) - 1);
+        cache->app_name[sizeof(cache->app_name) - 1] = '\0';
+        cache->focused_pid = snap.focused_pid;
+        cache->focused_uid = snap.focused_uid;
+        cache->screen_awake = snap.screen_awake;
+        cache->battery_saver = snap.battery_saver;
+        cache->zen_mode = snap.zen_mode;
+        cache->battery_level = snap.battery_level;
+        cache->is_charging = snap.is_charging;
+        return;
+    }
+
     FILE* fp = fopen("/data/adb/.config/AZenith/app_status", "r");
     if (!fp)
         return;
@@ -38,8 +186,7 @@ void read_app_status(SystemStateCache* cache) {
 
     while (fgets(line, sizeof(line), fp)) {
         if (strncmp(line, "focused_app ", 12) == 0) {
-            int uid;
-            sscanf(line + 12, "%127s %d %d", cache->focused_app, &cache->focused_pid, &uid);
+            sscanf(line + 12, "%127s %d %d", cache->focused_app, &cache->focused_pid, &cache->focused_uid);
         } else if (strncmp(line, "screen_awake ", 13) == 0) {
             sscanf(line + 13, "%d", &cache->screen_awake);
         } else if (strncmp(line, "battery_saver ", 14) == 0) {
@@ -38,17 +38,31 @@ void print_help(void) {
         "\n"
         "     -l,    --log <TAG> <LVL> <MSG>\n"
         "                               Write a log message via AZenith logging service\n"
+        "                               MSG '-' logs each line read from stdin\n"
         "                               LEVELs: 0=DEBUG, 1=INFO, 2=WARN, 3=ERROR, 4=FATAL\n"
         "\n"
         "     -vl,   --verboselog <TAG> <LVL> <MSG>\n"
         "                               Write a verbose log message via AZenith logging service\n"
         "\n"
+        "     -ld,   --logdump [FILE]   Render the binary log (persist.sys.azenith.binlog) as text\n"
+        "\n"
+        "     -s,    --status           Show the running daemon's profile and game\n"
+        "\n"
+        "     -rl,   --reload           Reload config files and gamelist in the running daemon\n"
+        "\n"
+        "     -st,   --stats [reset]    Show state transitions, shell pool savings and per-command\n"
+        "                               exec latency of the running daemon\n"
+        "                               reset : clear the statistics after printing them\n"
+        "\n"
         "     -actv, --appactivity      Open AZenith App Main Activity\n"
         "\n"
         "     -cbc,  --checkbypasschg   Check bypass charge compatibility\n"
         "\n"
         "     -bpl,  --bypasspathlist   Show all embedded bypass charging paths\n"
         "\n"
+        "     -bgl,  --benchgamelist [N]\n"
+        "                               Benchmark gamelist parsing on N synthetic entries (default 10000)\n"
+        "\n"
         "     -V,    --version          Show AZenith current version\n"
         "\n"
         "     -h,    --help             Display this help message and exit\n"
@@ -61,9 +75,40 @@ void print_help(void) {
         MODULE_VERSION);
 }
 
+/**
+ * @brief Prints the daemon's answer to a control request.
+ * @return 0 if the daemon reported success, 1 otherwise.
+ */
+static int print_response(const ControlResponse* resp) {
+    if (resp->text[0])
+        fprintf(resp->status == 0 ? stdout : stderr, "%s\n", resp->text);
+    return resp->status == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Logs every line read from stdin, used by helpers flushing buffered messages at once.
+ * @note Written straight to the log file, never through the daemon: the helpers log while the
+ * daemon's main thread waits for them.
+ * @return Always 0.
+ */
+static int log_stdin_lines(LogDest dest, int level, const char* tag) {
+    char line[1024];
+    while (fgets(line, sizeof(line), stdin)) {
+        trim_newline(line);
+        if (dest == LOG_DEST_MAIN)
+            external_log(level, tag, line);
+        else
+            external_vlog(level, tag, line);
+    }
+    return 0;
+}
+
 /**
  * @brief Handles manual performance profile selection via CLI argument.
- * @note Blocks execution if AI/Auto Mode is active in system properties.
+ * @note Blocks execution if AI/Auto Mode is active in system properties. The running daemon applies
+ * the profile and the command returns once it is done, it only runs standalone when the daemon
+ * cannot be reached. A daemon that took the request but never answered may still be applying it,
+ * so that is reported as an error instead of applying the profile a second time.
  * @param argc Number of CLI arguments.
  * @param argv Array of CLI argument strings.
  * @return 0 on success, or 1 if an invalid profile is requested or Auto Mode is enabled.
@@ -74,6 +119,20 @@ int handle_profile(int argc, char** argv) {
         return 1;
     }
 
+    const char* profile = argv[2];
+
+    if (!strcmp(profile, "1") || !strcmp(profile, "2") || !strcmp(profile, "3")) {
+        ControlRequest req = {.command = CTL_PROFILE, .arg = atoi(profile)};
+        ControlResponse resp;
+        int ret = control_request(&req, &resp);
+        if (ret == 0)
+            return print_response(&resp);
+        if (ret == CONTROL_NO_ANSWER) {
+            fprintf(stderr, "\033[31mERROR:\033[0m AZenith daemon took the request but did not answer.\n");
+            return 1;
+        }
+    }
+
     char ai_state[PROP_VALUE_MAX] = {0};
     __system_property_get("persist.sys.azenithconf.AIenabled", ai_state);
 
@@ -83,8 +142,6 @@ int handle_profile(int argc, char** argv) {
         return 1;
     }
 
-    const char* profile = argv[2];
-
     if (!strcmp(profile, "0")) {
         log_zenith(LOG_WARN, "WARN: Cannot Apply Profile 0 (Initialize)");
         printf("WARN: Cannot Apply Profile 0 (Initialize)\n");
@@ -92,11 +149,7 @@ int handle_profile(int argc, char** argv) {
         log_zenith(LOG_INFO, "Applying Performance Profile via execute");
         char lite_prop[PROP_VALUE_MAX] = {0};
         __system_property_get("persist.sys.azenithconf.cpulimit", lite_prop);
-        if (strcmp(lite_prop, "1") == 0) {
-            systemv("setprop persist.sys.azenithconf.litemode 1");
-        } else {
-            systemv("setprop persist.sys.azenithconf.litemode 0");
-        }
+        prop_set("persist.sys.azenithconf.litemode", strcmp(lite_prop, "1") == 0 ? "1" : "0");
         run_profiler(PERFORMANCE_PROFILE);
         notify("Performance Profile", "System is now at Powerful state", false, 0);
         printf("Applying Performance Profile\n");
@@ -141,6 +194,9 @@ int handle_log(int argc, char** argv) {
         return 1;
     }
 
+    if (argc == 5 && strcmp(argv[4], "-") == 0)
+        return log_stdin_lines(LOG_DEST_MAIN, level, tag);
+
     char message[1024];
     message[0] = '\0';
 
@@ -182,6 +238,9 @@ int handle_verboselog(int argc, char** argv) {
         return 1;
     }
 
+    if (argc == 5 && strcmp(argv[4], "-") == 0)
+        return log_stdin_lines(LOG_DEST_VERBOSE, level, tag);
+
     char message[1024];
     message[0] = '\0';
 
@@ -200,6 +259,58 @@ int handle_verboselog(int argc, char** argv) {
     return 0;
 }
 
+/**
+ * @brief Prints the running daemon's current profile, game and gamelist state.
+ * @return 0 on success, or 1 if the daemon did not answer.
+ */
+int handle_status(void) {
+    ControlRequest req = {.command = CTL_STATUS};
+    ControlResponse resp;
+    if (control_request(&req, &resp) != 0) {
+        fprintf(stderr, "\033[31mERROR:\033[0m AZenith daemon is not responding.\n");
+        return 1;
+    }
+    return print_response(&resp);
+}
+
+/**
+ * @brief Asks the running daemon to reload its config files and gamelist.
+ * @return 0 on success, or 1 if the daemon did not answer.
+ */
+int handle_reload(void) {
+    ControlRequest req = {.command = CTL_RELOAD};
+    ControlResponse resp;
+    if (control_request(&req, &resp) != 0) {
+        fprintf(stderr, "\033[31mERROR:\033[0m AZenith daemon is not responding.\n");
+        return 1;
+    }
+    return print_response(&resp);
+}
+
+/**
+ * @brief Prints the latency statistics of the external commands the daemon ran.
+ * @param argc Number of CLI arguments.
+ * @param argv Array of CLI argument strings, "reset" after the command clears the statistics.
+ * @return 0 on success, or 1 if the daemon did not answer.
+ */
+int handle_stats(int argc, char** argv) {
+    ControlRequest req = {.command = CTL_STATS};
+    if (argc > 2) {
+        if (strcmp(argv[2], "reset") != 0) {
+            fprintf(stderr, "Usage: --stats [reset]\n");
+            return 1;
+        }
+        req.arg = 1;
+    }
+
+    ControlResponse resp;
+    if (control_request(&req, &resp) != 0) {
+        fprintf(stderr, "\033[31mERROR:\033[0m AZenith daemon is not responding.\n");
+        return 1;
+    }
+    return print_response(&resp);
+}
+
 /**
  * @brief Prints the current AZenith module version string to stdout.
  */
@@ -16,124 +16,471 @@
 
 #include <AZenith.h>
 #include <android/log.h>
-#include <sys/system_properties.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include <sys/file.h>
+#include <sys/uio.h>
+
+#define LOG_RING_SLOTS 512
+#define LOG_LINE_MAX 512
+#define LOG_BATCH_MAX 64
+#define LOG_IDLE_TIMEOUT_MS 1000
 
 char* custom_log_tag = NULL;
 const char* level_str[] = {"D", "I", "W", "E", "F"};
 
+static const char* const log_paths[LOG_DEST_COUNT] = {LOG_FILE, LOG_VFILE, LOG_FILE_PRELOAD};
+
 /**
- * @brief Prints and logs a formatted message with a timestamp to a log file and Android logcat.
- * @param level Log level enum (LOG_INFO, LOG_WARN, etc.).
- * @param message Format string for the log message.
+ * @struct LogSlot
+ * @brief One preformatted log line in the writer ring.
+ * @note seq follows the bounded MPMC queue scheme: a producer owns the slot when seq equals its
+ * ticket, the writer owns it when seq equals ticket + 1.
  */
-void log_zenith(LogLevel level, const char* message, ...) {
-    char* timestamp = timern();
-    char logMesg[MAX_OUTPUT_LENGTH];
-    va_list args;
-    va_start(args, message);
-    vsnprintf(logMesg, sizeof(logMesg), message, args);
-    va_end(args);
+typedef struct {
+    atomic_size_t seq;
+    LogDest dest;
+    LogLevel level;
+    bool logcat;
+    unsigned short msg_offset;
+    unsigned short len;
+    char line[LOG_LINE_MAX];
+} LogSlot;
+
+static LogSlot ring[LOG_RING_SLOTS];
+static atomic_size_t ring_tail = 0;
+static size_t ring_head = 0;
 
-    write2file(LOG_FILE, true, true, "%s %s %s: %s\n", timestamp, level_str[level], LOG_TAG,
-               logMesg);
+static atomic_bool writer_running = false;
+static atomic_bool writer_idle = false;
+static atomic_bool writer_stopping = false;
+static atomic_uint dropped_lines = 0;
+static int wake_fd = -1;
+static int dest_fd[LOG_DEST_COUNT] = {-1, -1, -1};
+static pthread_t writer_thread;
+static pthread_mutex_t drain_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Formats the current local time for a log line.
+ * @note Caches the formatted second per thread so localtime_r only runs once per second.
+ * @param buf Destination buffer.
+ * @param len Size of the buffer.
+ */
+static void format_timestamp(char* buf, size_t len) {
+    static _Thread_local time_t cached_sec = -1;
+    static _Thread_local char cached[24];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    if (ts.tv_sec != cached_sec) {
+        struct tm tm;
+        if (!localtime_r(&ts.tv_sec, &tm) || strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", &tm) == 0)
+            [[clang::unlikely]] {
+            snprintf(buf, len, "[TimeError]");
+            return;
+        }
+        cached_sec = ts.tv_sec;
+    }
+
+    snprintf(buf, len, "%s.%03d", cached, (int)(ts.tv_nsec / 1000000));
+}
 
-    int android_log_level;
+/**
+ * @brief Maps a log level to its Android logcat priority.
+ */
+static int android_priority(LogLevel level) {
     switch (level) {
         case LOG_INFO:
-            android_log_level = ANDROID_LOG_INFO;
-            break;
+            return ANDROID_LOG_INFO;
         case LOG_WARN:
-            android_log_level = ANDROID_LOG_WARN;
-            break;
+            return ANDROID_LOG_WARN;
         case LOG_ERROR:
-            android_log_level = ANDROID_LOG_ERROR;
-            break;
+            return ANDROID_LOG_ERROR;
         default:
-            android_log_level = ANDROID_LOG_DEBUG;
+            return ANDROID_LOG_DEBUG;
+    }
+}
+
+/**
+ * @brief Checks whether debug logging is enabled.
+ */
+static bool debug_mode_enabled(void) {
+    return prop_cache_equals(PROP_DEBUGMODE, "true");
+}
+
+/**
+ * @brief Formats "<timestamp> <level> <tag>: <message>\n" into a line buffer.
+ * @param line Destination buffer of LOG_LINE_MAX bytes.
+ * @param msg_offset Set to the offset of the message inside the line.
+ * @return Length of the line, newline included.
+ */
+static size_t format_line(char* line, LogLevel level, const char* tag, unsigned short* msg_offset, const char* fmt,
+                          va_list args) {
+    char timestamp[48];
+    format_timestamp(timestamp, sizeof(timestamp));
+
+    int prefix = snprintf(line, LOG_LINE_MAX, "%s %s %s: ", timestamp, level_str[level], tag);
+    if (prefix < 0 || prefix >= LOG_LINE_MAX - 2) [[clang::unlikely]]
+        prefix = 0;
+
+    size_t room = LOG_LINE_MAX - prefix - 1;
+    int n = vsnprintf(line + prefix, room, fmt, args);
+    size_t len = prefix + (n < 0 ? 0 : (size_t)n < room ? (size_t)n : room - 1);
+    line[len++] = '\n';
+    line[len] = '\0';
+
+    *msg_offset = prefix;
+    return len;
+}
+
+/**
+ * @brief Writes a line straight to its file and logcat on the caller's thread.
+ * @note Used by CLI invocations, before the writer starts and for errors that found the ring full.
+ */
+static void write_line_sync(LogDest dest, LogLevel level, bool logcat, const char* line, size_t len,
+                            unsigned short msg_offset) {
+    write2file(log_paths[dest], true, true, "%.*s", (int)len, line);
+    if (logcat)
+        __android_log_print(android_priority(level), LOG_TAG, "%.*s", (int)(len - msg_offset - 1), line + msg_offset);
+}
+
+/**
+ * @brief Queues a log line for the writer thread, or writes it synchronously if it is not running.
+ * @note When the ring is full the line is dropped and counted, except errors which are written
+ * synchronously so they are never lost.
+ */
+static void submit_line(LogDest dest, LogLevel level, const char* tag, bool logcat, const char* fmt, va_list args) {
+    /* In binary mode only warnings and errors still get formatted, so the app log keeps showing problems */
+    if (binlog_active()) {
+        va_list copy;
+        va_copy(copy, args);
+        binlog_record(dest, level, strcmp(tag, LOG_TAG) == 0 ? NULL : tag, fmt, copy);
+        va_end(copy);
+        if (level < LOG_WARN)
+            return;
+    }
+
+    if (!atomic_load_explicit(&writer_running, memory_order_acquire)) {
+        char line[LOG_LINE_MAX];
+        unsigned short msg_offset;
+        size_t len = format_line(line, level, tag, &msg_offset, fmt, args);
+        write_line_sync(dest, level, logcat, line, len, msg_offset);
+        return;
+    }
+
+    size_t pos = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &ring[pos & (LOG_RING_SLOTS - 1)];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring_tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (diff < 0) [[clang::unlikely]] {
+            if (level >= LOG_ERROR) {
+                char line[LOG_LINE_MAX];
+                unsigned short msg_offset;
+                size_t len = format_line(line, level, tag, &msg_offset, fmt, args);
+                write_line_sync(dest, level, logcat, line, len, msg_offset);
+            } else {
+                atomic_fetch_add_explicit(&dropped_lines, 1, memory_order_relaxed);
+            }
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring_tail, memory_order_relaxed);
+        }
+    }
+
+    slot->dest = dest;
+    slot->level = level;
+    slot->logcat = logcat;
+    slot->len = format_line(slot->line, level, tag, &slot->msg_offset, fmt, args);
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    /* Pairs with the fence in log_writer_worker(): either the writer sees this slot or we see it idle */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&writer_idle, memory_order_relaxed)) {
+        uint64_t one = 1;
+        ssize_t ret = write(wake_fd, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+/**
+ * @brief Returns an open append descriptor for a log file, reopening it if it was deleted.
+ * @note clearlogs removes the files, so a descriptor whose inode lost its last link is replaced.
+ */
+static int dest_descriptor(LogDest dest) {
+    struct stat st;
+    if (dest_fd[dest] >= 0 && fstat(dest_fd[dest], &st) == 0 && st.st_nlink > 0)
+        return dest_fd[dest];
+
+    if (dest_fd[dest] >= 0)
+        close(dest_fd[dest]);
+    dest_fd[dest] = open(log_paths[dest], O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    return dest_fd[dest];
+}
+
+/**
+ * @brief Appends a batch of lines to one log file under the shared flock.
+ */
+static void write_batch(LogDest dest, struct iovec* iov, int count) {
+    if (count == 0)
+        return;
+
+    int fd = dest_descriptor(dest);
+    if (fd < 0)
+        return;
+
+    flock(fd, LOCK_EX);
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
             break;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
     }
+    flock(fd, LOCK_UN);
+}
+
+/**
+ * @brief Writes every published line in the ring, one writev per file per batch.
+ * @note Caller must hold drain_mutex, the ring has a single consumer.
+ * @return Number of lines written.
+ */
+static int drain_ring(void) {
+    int total = 0;
 
-    __android_log_print(android_log_level, LOG_TAG, "%s", logMesg);
+    for (;;) {
+        struct iovec iov[LOG_DEST_COUNT][LOG_BATCH_MAX];
+        int iov_count[LOG_DEST_COUNT] = {0};
+        int batch = 0;
+
+        unsigned int dropped = atomic_exchange_explicit(&dropped_lines, 0, memory_order_relaxed);
+        char notice[LOG_LINE_MAX];
+        if (dropped > 0) [[clang::unlikely]] {
+            char timestamp[48];
+            format_timestamp(timestamp, sizeof(timestamp));
+            int len = snprintf(notice, sizeof(notice), "%s %s %s: Log buffer full, dropped %u lines\n", timestamp,
+                               level_str[LOG_WARN], LOG_TAG, dropped);
+            iov[LOG_DEST_MAIN][iov_count[LOG_DEST_MAIN]++] = (struct iovec){notice, (size_t)len};
+        }
+
+        while (batch < LOG_BATCH_MAX) {
+            LogSlot* slot = &ring[(ring_head + batch) & (LOG_RING_SLOTS - 1)];
+            if (atomic_load_explicit(&slot->seq, memory_order_acquire) != ring_head + batch + 1)
+                break;
+            if (iov_count[slot->dest] == LOG_BATCH_MAX)
+                break;
+            iov[slot->dest][iov_count[slot->dest]++] = (struct iovec){slot->line, slot->len};
+            batch++;
+        }
+
+        if (batch == 0 && dropped == 0)
+            return total;
+
+        for (int d = 0; d < LOG_DEST_COUNT; d++)
+            write_batch(d, iov[d], iov_count[d]);
+
+        for (int i = 0; i < batch; i++) {
+            LogSlot* slot = &ring[ring_head & (LOG_RING_SLOTS - 1)];
+            if (slot->logcat)
+                __android_log_write(android_priority(slot->level), LOG_TAG, slot->line + slot->msg_offset);
+            atomic_store_explicit(&slot->seq, ring_head + LOG_RING_SLOTS, memory_order_release);
+            ring_head++;
+        }
+        total += batch;
+    }
 }
 
 /**
- * @brief Logs preloading process information if the system debug mode property is enabled.
- * @param level Log level enum.
- * @param message Format string for the preload log message.
+ * @brief Checks whether the next ring slot holds a published line.
  */
-void log_preload(LogLevel level, const char* message, ...) {
-    char val[PROP_VALUE_MAX] = {0};
-    if (__system_property_get("persist.sys.azenith.debugmode", val) > 0) {
-        if (strcmp(val, "true") == 0) {
-            char* timestamp = timern();
-            char logMesg[MAX_OUTPUT_LENGTH];
-            va_list args;
-            va_start(args, message);
-            vsnprintf(logMesg, sizeof(logMesg), message, args);
-            va_end(args);
-
-            write2file(LOG_FILE_PRELOAD, true, true, "%s %s %s: %s\n", timestamp, level_str[level],
-                       LOG_TAG, logMesg);
-
-            int android_log_level;
-            switch (level) {
-                case LOG_INFO:
-                    android_log_level = ANDROID_LOG_INFO;
-                    break;
-                case LOG_WARN:
-                    android_log_level = ANDROID_LOG_WARN;
-                    break;
-                case LOG_ERROR:
-                    android_log_level = ANDROID_LOG_ERROR;
-                    break;
-                default:
-                    android_log_level = ANDROID_LOG_DEBUG;
-                    break;
+static bool ring_has_pending(void) {
+    LogSlot* slot = &ring[ring_head & (LOG_RING_SLOTS - 1)];
+    return atomic_load_explicit(&slot->seq, memory_order_acquire) == ring_head + 1;
+}
+
+/**
+ * @brief Writer thread: sleeps on the wake eventfd and drains the ring in batches.
+ */
+static void* log_writer_worker(void* arg) {
+    (void)arg;
+    pthread_setname_np(pthread_self(), "AZenithLog");
+
+    while (!atomic_load(&writer_stopping)) {
+        pthread_mutex_lock(&drain_mutex);
+        drain_ring();
+        atomic_store_explicit(&writer_idle, true, memory_order_relaxed);
+        /* Store-load ordering, release and acquire alone would let the seq load pass the idle store */
+        atomic_thread_fence(memory_order_seq_cst);
+        bool pending = ring_has_pending();
+        pthread_mutex_unlock(&drain_mutex);
+
+        if (!pending && !atomic_load(&writer_stopping)) {
+            struct pollfd pfd = {.fd = wake_fd, .events = POLLIN};
+            if (poll(&pfd, 1, LOG_IDLE_TIMEOUT_MS) > 0) {
+                uint64_t value;
+                ssize_t ret = read(wake_fd, &value, sizeof(value));
+                (void)ret;
             }
+        }
+        atomic_store(&writer_idle, false);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Starts the log writer thread so log calls stop touching the log files.
+ * @note Must be called after daemon(). Lines still queued are written on exit() through an atexit
+ * handler, sighandler() flushes explicitly since _exit() skips it.
+ */
+void log_writer_start(void) {
+    if (atomic_load(&writer_running))
+        return;
+
+    for (size_t i = 0; i < LOG_RING_SLOTS; i++)
+        atomic_init(&ring[i].seq, i);
+    atomic_store(&ring_tail, 0);
+    ring_head = 0;
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0) {
+        log_zenith(LOG_WARN, "Failed to create log writer eventfd, logging synchronously");
+        return;
+    }
+
+    /* Termination signals must land on a thread that can flush, never on the writer itself */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGTERM);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    atomic_store(&writer_stopping, false);
+    int ret = pthread_create(&writer_thread, NULL, log_writer_worker, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (ret != 0) {
+        close(wake_fd);
+        wake_fd = -1;
+        log_zenith(LOG_WARN, "Failed to spawn log writer thread, logging synchronously");
+        return;
+    }
+
+    atomic_store_explicit(&writer_running, true, memory_order_release);
+    atexit(log_writer_stop);
+}
+
+/**
+ * @brief Writes every queued log line before returning.
+ * @note Safe to call from sighandler(): the writer thread blocks termination signals, so the
+ * drain lock is never held by the interrupted thread.
+ */
+void log_writer_flush(void) {
+    if (!atomic_load(&writer_running))
+        return;
+
+    pthread_mutex_lock(&drain_mutex);
+    drain_ring();
+    pthread_mutex_unlock(&drain_mutex);
+}
+
+/**
+ * @brief Flushes the ring, stops the writer thread and closes the log files.
+ */
+void log_writer_stop(void) {
+    if (!atomic_exchange(&writer_running, false))
+        return;
+
+    atomic_store(&writer_stopping, true);
+    uint64_t one = 1;
+    ssize_t ret = write(wake_fd, &one, sizeof(one));
+    (void)ret;
+    pthread_join(writer_thread, NULL);
+
+    /* Producers that raced the stop published into the ring, write them out here */
+    pthread_mutex_lock(&drain_mutex);
+    drain_ring();
+    pthread_mutex_unlock(&drain_mutex);
 
-            __android_log_print(android_log_level, LOG_TAG, "%s", logMesg);
+    for (int d = 0; d < LOG_DEST_COUNT; d++) {
+        if (dest_fd[d] >= 0) {
+            close(dest_fd[d]);
+            dest_fd[d] = -1;
         }
     }
+    close(wake_fd);
+    wake_fd = -1;
+}
+
+/**
+ * @brief Prints and logs a formatted message with a timestamp to a log file and Android logcat.
+ * @param level Log level enum (LOG_INFO, LOG_WARN, etc.).
+ * @param message Format string for the log message.
+ */
+void log_zenith(LogLevel level, const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    submit_line(LOG_DEST_MAIN, level, LOG_TAG, true, message, args);
+    va_end(args);
+}
+
+/**
+ * @brief Logs preloading process information if the system debug mode property is enabled.
+ * @note Always recorded when the binary log is active, it costs no formatting there.
+ * @param level Log level enum.
+ * @param message Format string for the preload log message.
+ */
+void log_preload(LogLevel level, const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    if (debug_mode_enabled())
+        submit_line(LOG_DEST_PRELOAD, level, LOG_TAG, true, message, args);
+    else if (binlog_active())
+        binlog_record(LOG_DEST_PRELOAD, level, NULL, message, args);
+    va_end(args);
 }
 
 /**
  * @brief Logs detailed debug/verbose info to the main log file when debug mode is enabled.
+ * @note Always recorded when the binary log is active, it costs no formatting there.
  * @param level Log level enum.
  * @param message Format string for the verbose log message.
  */
 void log_verbose(LogLevel level, const char* message, ...) {
-    char val[PROP_VALUE_MAX] = {0};
-    if (__system_property_get("persist.sys.azenith.debugmode", val) > 0) {
-        if (strcmp(val, "true") == 0) {
-            char* timestamp = timern();
-            char logMesg[MAX_OUTPUT_LENGTH];
-            va_list args;
-            va_start(args, message);
-            vsnprintf(logMesg, sizeof(logMesg), message, args);
-            va_end(args);
-
-            write2file(LOG_FILE, true, true, "%s %s %s: %s\n", timestamp, level_str[level], LOG_TAG,
-                       logMesg);
-
-            int android_log_level;
-            switch (level) {
-                case LOG_INFO:
-                    android_log_level = ANDROID_LOG_INFO;
-                    break;
-                case LOG_WARN:
-                    android_log_level = ANDROID_LOG_WARN;
-                    break;
-                case LOG_ERROR:
-                    android_log_level = ANDROID_LOG_ERROR;
-                    break;
-                default:
-                    android_log_level = ANDROID_LOG_DEBUG;
-                    break;
-            }
+    va_list args;
+    va_start(args, message);
+    if (debug_mode_enabled())
+        submit_line(LOG_DEST_MAIN, level, LOG_TAG, true, message, args);
+    else if (binlog_active())
+        binlog_record(LOG_DEST_MAIN, level, NULL, message, args);
+    va_end(args);
+}
 
-            __android_log_print(android_log_level, LOG_TAG, "%s", logMesg);
-        }
-    }
+/**
+ * @brief Queues a preformatted message under a custom tag.
+ */
+static void external_line(LogDest dest, LogLevel level, const char* tag, const char* message, ...) {
+    va_list args;
+    va_start(args, message);
+    submit_line(dest, level, tag, false, message, args);
+    va_end(args);
 }
 
 /**
@@ -143,8 +490,7 @@ void log_verbose(LogLevel level, const char* message, ...) {
  * @param message Raw log message string.
  */
 void external_log(LogLevel level, const char* tag, const char* message) {
-    char* timestamp = timern();
-    write2file(LOG_FILE, true, true, "%s %s %s: %s\n", timestamp, level_str[level], tag, message);
+    external_line(LOG_DEST_MAIN, level, tag, "%s", message);
 }
 
 /**
@@ -154,6 +500,5 @@ void external_log(LogLevel level, const char* tag, const char* message) {
  * @param message Raw log message string.
  */
 void external_vlog(LogLevel level, const char* tag, const char* message) {
-    char* timestamp = timern();
-    write2file(LOG_VFILE, true, true, "%s %s %s: %s\n", timestamp, level_str[level], tag, message);
+    external_line(LOG_DEST_VERBOSE, level, tag, "%s", message);
 }
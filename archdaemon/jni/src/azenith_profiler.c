@@ -46,8 +46,9 @@ bool get_low_power_state_normal(SystemStateCache* cache) {
 /**
  * @brief Switch to specified performance profile.
  * @param profile 0 for perfcommon, 1 for performance, 2 for balanced, 3 for powersave.
+ * @return Exit status of the profile settings script, or EXEC_TIMED_OUT if it hung and was killed.
  */
-void run_profiler(const int profile) {
+int run_profiler(const int profile) {
     is_kanged();
 
     time_t t = time(NULL);
@@ -71,8 +72,9 @@ void run_profiler(const int profile) {
     write2file(PROFILE_MODE, false, false, "%d\n", profile);
     write2file(PROFILE_MODE_APP, false, false, "%d\n", profile);
 
-    // Suggestion for future: Replace systemv with native property setting for performance
-    (void)systemv("sys.azenith-profilesettings %d", profile);
+    char command[8];
+    snprintf(command, sizeof(command), "%d", profile);
+    return run_profilesettings(command);
 }
 
 /**
@@ -86,33 +88,15 @@ char* get_gamestart(GameConfig* options, SystemStateCache* cache) {
     if (!pkg)
         return NULL;
 
-    pthread_mutex_lock(&cache_mutex);
+    unsigned int ticket;
+    const GameList* list = gamelist_acquire(&ticket);
 
-    if (g_game_cache == NULL || g_game_cache_count == 0) {
-        pthread_mutex_unlock(&cache_mutex);
-        free(pkg);
-        return NULL;
-    }
-
-    bool match_found = false;
-
-    for (int i = 0; i < g_game_cache_count; i++) {
-        if (strcmp(g_game_cache[i].package, pkg) == 0) {
-            match_found = true;
-
-            if (options) {
-                strcpy(options->perf_lite_mode, g_game_cache[i].perf_lite_mode);
-                strcpy(options->dnd_on_gaming, g_game_cache[i].dnd_on_gaming);
-                strcpy(options->app_priority, g_game_cache[i].app_priority);
-                strcpy(options->game_preload, g_game_cache[i].game_preload);
-                strcpy(options->refresh_rate, g_game_cache[i].refresh_rate);
-                strcpy(options->renderer, g_game_cache[i].renderer);
-            }
-            break;
-        }
-    }
+    int idx = list ? find_game_index(list->games, list->index, list->index_mask, pkg) : -1;
+    bool match_found = idx >= 0;
+    if (match_found && options)
+        *options = list->games[idx];
 
-    pthread_mutex_unlock(&cache_mutex);
+    gamelist_release(ticket);
 
     if (!match_found) {
         free(pkg);
@@ -0,0 +1,739 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <AZenith.h>
+#include <elf.h>
+#include <link.h>
+#include <sys/mman.h>
+
+#define BINLOG_MAGIC 0x4C425A41u /* "AZBL" */
+#define BINLOG_VERSION 1
+#define BINLOG_DATA_OFFSET 4096
+#define BINLOG_DATA_SIZE (1u << 20)
+#define BINLOG_RECORD_MAX 1024
+#define BINLOG_STRING_MAX 255
+#define BINLOG_TEXT_MAX 512
+#define BINLOG_RAW_FORMAT UINT32_MAX
+#define BINLOG_CUSTOM_TAG 0x80
+#define BINLOG_MAX_SEGMENTS 4
+
+/**
+ * @struct BinLogHeader
+ * @brief Header of the binary log file, followed by the record ring at BINLOG_DATA_OFFSET.
+ * @note head counts every byte ever reserved, the ring offset of a position is head % data_size.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t data_size;
+    uint64_t head;
+    int64_t realtime_offset_ns;
+    char boot_id[40];
+    char build_id[72];
+} BinLogHeader;
+
+/**
+ * @struct BinLogRecord
+ * @brief Fixed part of a record, followed by the optional tag and the raw arguments.
+ * @note pos holds the low bits of the record position and is stored last, a reader only trusts a
+ * record whose pos matches where it was found. Arguments take 8 bytes each, strings a 16-bit
+ * length and their bytes padded to 8.
+ */
+typedef struct {
+    uint32_t pos;
+    uint16_t len;
+    uint8_t level;
+    uint8_t dest;
+    uint32_t fmt;
+    uint32_t tid;
+    uint64_t mono_ns;
+} BinLogRecord;
+
+_Static_assert(sizeof(BinLogHeader) <= BINLOG_DATA_OFFSET, "BinLogHeader exceeds header page");
+_Static_assert(sizeof(BinLogRecord) == 24, "BinLogRecord layout changed");
+_Static_assert((BINLOG_DATA_SIZE & (BINLOG_DATA_SIZE - 1)) == 0, "Ring size must be a power of two");
+
+/**
+ * @struct ImageInfo
+ * @brief Read-only segments of the running executable, where format string literals live.
+ */
+typedef struct {
+    uintptr_t base;
+    uintptr_t start[BINLOG_MAX_SEGMENTS];
+    uintptr_t end[BINLOG_MAX_SEGMENTS];
+    int count;
+    char build_id[72];
+} ImageInfo;
+
+typedef enum : char {
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_SIZE,
+    ARG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER,
+    ARG_INVALID
+} ArgKind;
+
+/**
+ * @struct Conversion
+ * @brief One printf conversion found in a format string.
+ */
+typedef struct {
+    const char* start;
+    size_t len;
+    int stars;
+    ArgKind kind;
+} Conversion;
+
+static const char* const dest_suffix[LOG_DEST_COUNT] = {"", "/verbose", "/preload"};
+
+static ImageInfo image;
+static BinLogHeader* header = NULL;
+static unsigned char* ring = NULL;
+
+/**
+ * @brief dl_iterate_phdr callback collecting the segments and build id of the object holding image.
+ */
+static int collect_image(struct dl_phdr_info* info, size_t size, void* data) {
+    (void)size;
+    ImageInfo* out = data;
+    uintptr_t self = (uintptr_t)&image;
+    bool found = false;
+
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        uintptr_t start = info->dlpi_addr + ph->p_vaddr;
+        if (ph->p_type == PT_LOAD && self >= start && self < start + ph->p_memsz)
+            found = true;
+    }
+    if (!found)
+        return 0;
+
+    out->base = info->dlpi_addr;
+    size_t text_size = 0;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        uintptr_t start = info->dlpi_addr + ph->p_vaddr;
+
+        if (ph->p_type == PT_LOAD && !(ph->p_flags & PF_W) && out->count < BINLOG_MAX_SEGMENTS) {
+            out->start[out->count] = start;
+            out->end[out->count++] = start + ph->p_memsz;
+            text_size += ph->p_memsz;
+        } else if (ph->p_type == PT_NOTE && !out->build_id[0]) {
+            const unsigned char* p = (const unsigned char*)start;
+            const unsigned char* end = p + ph->p_memsz;
+            while (p + sizeof(ElfW(Nhdr)) <= end) {
+                const ElfW(Nhdr)* note = (const ElfW(Nhdr)*)p;
+                const unsigned char* name = p + sizeof(*note);
+                const unsigned char* desc = name + ((note->n_namesz + 3) & ~3u);
+                if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && memcmp(name, "GNU", 4) == 0) {
+                    for (size_t j = 0; j < note->n_descsz && j * 2 + 2 < sizeof(out->build_id); j++)
+                        snprintf(out->build_id + j * 2, 3, "%02x", desc[j]);
+                    break;
+                }
+                p = desc + ((note->n_descsz + 3) & ~3u);
+            }
+        }
+    }
+
+    /* Without a build id, fall back to something that changes with every rebuild of the daemon */
+    if (!out->build_id[0])
+        snprintf(out->build_id, sizeof(out->build_id), "%s %s %s %zx", MODULE_VERSION, __DATE__, __TIME__, text_size);
+    return 1;
+}
+
+/**
+ * @brief Locates the read-only segments of the running executable.
+ * @return true if the executable was found.
+ */
+static bool load_image_info(ImageInfo* out) {
+    memset(out, 0, sizeof(*out));
+    return dl_iterate_phdr(collect_image, out) == 1 && out->count > 0;
+}
+
+/**
+ * @brief Finds the read-only segment of the executable holding an address.
+ * @return Segment index, or -1 if the address is outside them.
+ */
+static int image_segment(const ImageInfo* info, const void* ptr) {
+    uintptr_t addr = (uintptr_t)ptr;
+    for (int i = 0; i < info->count; i++) {
+        if (addr >= info->start[i] && addr < info->end[i])
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Reads the kernel boot id, records are only comparable within one boot.
+ */
+static void read_boot_id(char* buf, size_t len) {
+    buf[0] = '\0';
+    int fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    ssize_t n = read(fd, buf, len - 1);
+    close(fd);
+    buf[n > 0 ? n : 0] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+}
+
+/**
+ * @brief Returns a clock reading in nanoseconds.
+ */
+static int64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Finds the next printf conversion in a format string.
+ * @note "%%" is skipped, '*' width and precision are counted in stars and each take an int argument
+ * before the value itself.
+ * @param p Position to scan from.
+ * @param conv Destination for the conversion.
+ * @return Pointer past the conversion, or NULL if there are no more conversions.
+ */
+static const char* next_conversion(const char* p, Conversion* conv) {
+    while ((p = strchr(p, '%'))) {
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+
+        conv->start = p++;
+        conv->stars = 0;
+        p += strspn(p, "-+ #0'");
+        if (*p == '*') {
+            conv->stars++;
+            p++;
+        } else {
+            p += strspn(p, "0123456789");
+        }
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                conv->stars++;
+                p++;
+            } else {
+                p += strspn(p, "0123456789");
+            }
+        }
+
+        int longs = 0;
+        bool sized = false;
+        while (*p == 'h')
+            p++;
+        if (*p == 'l') {
+            longs = p[1] == 'l' ? 2 : 1;
+            p += longs;
+        } else if (*p == 'j') {
+            longs = 2;
+            p++;
+        } else if (*p == 'z' || *p == 't') {
+            sized = true;
+            p++;
+        }
+
+        switch (*p) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                conv->kind = sized ? ARG_SIZE : longs == 2 ? ARG_LLONG : longs == 1 ? ARG_LONG : ARG_INT;
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                conv->kind = ARG_DOUBLE;
+                break;
+            case 's':
+                conv->kind = longs ? ARG_INVALID : ARG_STRING;
+                break;
+            case 'p':
+                conv->kind = ARG_POINTER;
+                break;
+            default:
+                conv->kind = ARG_INVALID;
+                break;
+        }
+        if (*p)
+            p++;
+        conv->len = p - conv->start;
+        return p;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Appends one 8-byte argument slot to a record.
+ * @return false if the record is full.
+ */
+static bool put_value(unsigned char* rec, size_t* len, uint64_t value) {
+    if (*len + sizeof(value) > BINLOG_RECORD_MAX)
+        return false;
+    memcpy(rec + *len, &value, sizeof(value));
+    *len += sizeof(value);
+    return true;
+}
+
+/**
+ * @brief Appends a length-prefixed string to a record, truncating it to what fits.
+ * @return false if the record is full.
+ */
+static bool put_string(unsigned char* rec, size_t* len, const char* s, size_t max) {
+    if (!s)
+        s = "(null)";
+    if (*len + sizeof(uint64_t) > BINLOG_RECORD_MAX)
+        return false;
+
+    size_t room = BINLOG_RECORD_MAX - *len - sizeof(uint16_t);
+    uint16_t n = strnlen(s, max < room ? max : room);
+    size_t padded = (sizeof(n) + n + 7) & ~(size_t)7;
+
+    memcpy(rec + *len, &n, sizeof(n));
+    memcpy(rec + *len + sizeof(n), s, n);
+    memset(rec + *len + sizeof(n) + n, 0, padded - sizeof(n) - n);
+    *len += padded;
+    return true;
+}
+
+/**
+ * @brief Stores the arguments of a format string as raw values.
+ * @note Strings are copied since they rarely outlive the call, everything else is stored as is.
+ * @return false if the format holds a conversion that cannot be stored or the record is full.
+ */
+static bool encode_args(unsigned char* rec, size_t* len, const char* fmt, va_list args) {
+    Conversion conv;
+    for (const char* p = fmt; (p = next_conversion(p, &conv));) {
+        for (int i = 0; i < conv.stars; i++) {
+            if (!put_value(rec, len, (uint64_t)(int64_t)va_arg(args, int)))
+                return false;
+        }
+
+        uint64_t value;
+        switch (conv.kind) {
+            case ARG_INT:
+                value = (uint64_t)(int64_t)va_arg(args, int);
+                break;
+            case ARG_LONG:
+                value = (uint64_t)(int64_t)va_arg(args, long);
+                break;
+            case ARG_LLONG:
+                value = (uint64_t)va_arg(args, long long);
+                break;
+            case ARG_SIZE:
+                value = (uint64_t)va_arg(args, size_t);
+                break;
+            case ARG_DOUBLE: {
+                double d = va_arg(args, double);
+                memcpy(&value, &d, sizeof(value));
+                break;
+            }
+            case ARG_POINTER:
+                value = (uintptr_t)va_arg(args, void*);
+                break;
+            case ARG_STRING:
+                if (!put_string(rec, len, va_arg(args, const char*), BINLOG_STRING_MAX))
+                    return false;
+                continue;
+            default:
+                return false;
+        }
+        if (!put_value(rec, len, value))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Copies bytes into the ring at a position, wrapping at its end.
+ */
+static void ring_write(uint64_t pos, const void* src, size_t len) {
+    size_t off = pos & (BINLOG_DATA_SIZE - 1);
+    size_t first = len < BINLOG_DATA_SIZE - off ? len : BINLOG_DATA_SIZE - off;
+    memcpy(ring + off, src, first);
+    memcpy(ring, (const char*)src + first, len - first);
+}
+
+/**
+ * @brief Copies bytes out of a ring at a position, wrapping at its end.
+ */
+static void ring_read(const unsigned char* data, uint64_t pos, void* dst, size_t len) {
+    size_t off = pos & (BINLOG_DATA_SIZE - 1);
+    size_t first = len < BINLOG_DATA_SIZE - off ? len : BINLOG_DATA_SIZE - off;
+    memcpy(dst, data + off, first);
+    memcpy((char*)dst + first, data, len - first);
+}
+
+/**
+ * @brief Maps the binary log ring if persist.sys.azenith.binlog is enabled.
+ * @note Keeps the records of a previous daemon run when it was the same build in the same boot,
+ * otherwise starts an empty ring. Called once at daemon startup, toggling needs a restart.
+ * @return true if log calls are now recorded in binary form.
+ */
+bool binlog_open(void) {
+    char value[PROP_VALUE_MAX] = {0};
+    __system_property_get("persist.sys.azenith.binlog", value);
+    if (strcmp(value, "true") != 0)
+        return false;
+
+    if (!load_image_info(&image)) {
+        log_zenith(LOG_WARN, "Binary log unavailable, executable segments not found");
+        return false;
+    }
+
+    size_t map_len = BINLOG_DATA_OFFSET + BINLOG_DATA_SIZE;
+    int fd = open(BINLOG_FILE, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_zenith(LOG_WARN, "Binary log unavailable: %s", strerror(errno));
+        return false;
+    }
+
+    /* Reserve the blocks now, a write fault on a full disk would be SIGBUS instead of an error */
+    int err = posix_fallocate(fd, 0, map_len);
+    void* map = err == 0 ? mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        log_zenith(LOG_WARN, "Binary log unavailable: %s", strerror(err ? err : errno));
+        return false;
+    }
+
+    BinLogHeader* hdr = map;
+    char boot_id[sizeof(hdr->boot_id)];
+    read_boot_id(boot_id, sizeof(boot_id));
+
+    bool reuse = hdr->magic == BINLOG_MAGIC && hdr->version == BINLOG_VERSION && hdr->data_size == BINLOG_DATA_SIZE &&
+                 strncmp(hdr->build_id, image.build_id, sizeof(hdr->build_id)) == 0 &&
+                 strncmp(hdr->boot_id, boot_id, sizeof(hdr->boot_id)) == 0;
+    if (!reuse) {
+        memset(map, 0, map_len);
+        hdr->magic = BINLOG_MAGIC;
+        hdr->version = BINLOG_VERSION;
+        hdr->data_size = BINLOG_DATA_SIZE;
+        memcpy(hdr->boot_id, boot_id, sizeof(hdr->boot_id));
+        snprintf(hdr->build_id, sizeof(hdr->build_id), "%s", image.build_id);
+    }
+    hdr->realtime_offset_ns = clock_ns(CLOCK_REALTIME) - clock_ns(CLOCK_MONOTONIC);
+
+    log_zenith(LOG_INFO, "Binary log enabled, decode with --logdump");
+    ring = (unsigned char*)map + BINLOG_DATA_OFFSET;
+    __atomic_store_n(&header, hdr, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * @brief Checks whether log calls are recorded in binary form.
+ */
+bool binlog_active(void) {
+    return __atomic_load_n(&header, __ATOMIC_ACQUIRE) != NULL;
+}
+
+/**
+ * @brief Records a log call as its format string offset and raw arguments.
+ * @note Formats are only referenced when they live in the executable's read-only segments, anything
+ * else, or a format whose arguments cannot be stored, is recorded preformatted.
+ * @param dest Log file the message belongs to.
+ * @param level Log level enum.
+ * @param tag Custom tag, or NULL for LOG_TAG.
+ * @param fmt Format string of the message.
+ * @param args Arguments of the format string.
+ */
+void binlog_record(LogDest dest, LogLevel level, const char* tag, const char* fmt, va_list args) {
+    BinLogHeader* hdr = __atomic_load_n(&header, __ATOMIC_ACQUIRE);
+    if (!hdr)
+        return;
+
+    unsigned char buf[BINLOG_RECORD_MAX] __attribute__((aligned(8)));
+    BinLogRecord* rec = (BinLogRecord*)buf;
+    size_t len = sizeof(*rec);
+
+    rec->dest = dest;
+    if (tag) {
+        rec->dest |= BINLOG_CUSTOM_TAG;
+        put_string(buf, &len, tag, BINLOG_STRING_MAX);
+    }
+
+    size_t args_offset = len;
+    va_list copy;
+    va_copy(copy, args);
+    bool encoded = image_segment(&image, fmt) >= 0 && encode_args(buf, &len, fmt, copy);
+    va_end(copy);
+
+    if (encoded) {
+        rec->fmt = (uintptr_t)fmt - image.base;
+    } else {
+        char text[BINLOG_TEXT_MAX];
+        vsnprintf(text, sizeof(text), fmt, args);
+        len = args_offset;
+        put_string(buf, &len, text, sizeof(text));
+        rec->fmt = BINLOG_RAW_FORMAT;
+    }
+
+    rec->len = len;
+    rec->level = level;
+    rec->tid = gettid();
+    rec->mono_ns = clock_ns(CLOCK_MONOTONIC);
+
+    uint64_t pos = __atomic_fetch_add(&hdr->head, len, __ATOMIC_RELAXED);
+    rec->pos = (uint32_t)pos;
+    ring_write(pos + sizeof(rec->pos), buf + sizeof(rec->pos), len - sizeof(rec->pos));
+    __atomic_store_n((uint32_t*)(ring + (pos & (BINLOG_DATA_SIZE - 1))), rec->pos, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Reads one 8-byte argument slot from a record.
+ * @return false if the record ends first.
+ */
+static bool take_value(const unsigned char* rec, size_t len, size_t* off, uint64_t* value) {
+    if (*off + sizeof(*value) > len)
+        return false;
+    memcpy(value, rec + *off, sizeof(*value));
+    *off += sizeof(*value);
+    return true;
+}
+
+/**
+ * @brief Reads a length-prefixed string from a record into a NUL-terminated buffer.
+ * @return false if the record ends first.
+ */
+static bool take_string(const unsigned char* rec, size_t len, size_t* off, char* out, size_t out_len) {
+    uint16_t n;
+    if (*off + sizeof(n) > len)
+        return false;
+    memcpy(&n, rec + *off, sizeof(n));
+    size_t padded = (sizeof(n) + n + 7) & ~(size_t)7;
+    if (*off + padded > len || n >= out_len)
+        return false;
+
+    memcpy(out, rec + *off + sizeof(n), n);
+    out[n] = '\0';
+    *off += padded;
+    return true;
+}
+
+/**
+ * @brief Appends format text between conversions, collapsing "%%".
+ */
+static void append_literal(char* out, size_t out_len, size_t* n, const char* start, const char* end) {
+    while (start < end && *n + 1 < out_len) {
+        out[(*n)++] = *start;
+        start += start[0] == '%' && start + 1 < end && start[1] == '%' ? 2 : 1;
+    }
+    out[*n] = '\0';
+}
+
+#define EMIT_CONVERSION(value)                                                                                       \
+    (conv.stars == 0   ? snprintf(out + n, out_len - n, spec, value)                                                \
+     : conv.stars == 1 ? snprintf(out + n, out_len - n, spec, star[0], value)                                       \
+                       : snprintf(out + n, out_len - n, spec, star[0], star[1], value))
+
+/**
+ * @brief Renders a recorded message by replaying its arguments through the format one conversion
+ * at a time.
+ * @param rec Record bytes.
+ * @param len Record length.
+ * @param off Offset of the first argument.
+ * @param fmt Format string the record was made with.
+ * @param out Destination buffer.
+ * @param out_len Size of the destination buffer.
+ */
+static void render_message(const unsigned char* rec, size_t len, size_t off, const char* fmt, char* out,
+                           size_t out_len) {
+    Conversion conv;
+    size_t n = 0;
+    const char* p = fmt;
+    const char* next;
+    out[0] = '\0';
+
+    while ((next = next_conversion(p, &conv))) {
+        append_literal(out, out_len, &n, p, conv.start);
+        p = next;
+
+        char spec[32];
+        int star[2] = {0, 0};
+        uint64_t value = 0;
+        char str[BINLOG_STRING_MAX + 1];
+        bool ok = conv.kind != ARG_INVALID && conv.len < sizeof(spec);
+        for (int i = 0; ok && i < conv.stars; i++) {
+            ok = take_value(rec, len, &off, &value);
+            star[i] = (int)(int64_t)value;
+        }
+        if (ok)
+            ok = conv.kind == ARG_STRING ? take_string(rec, len, &off, str, sizeof(str))
+                                         : take_value(rec, len, &off, &value);
+        if (!ok) {
+            static const char truncated[] = "<?>";
+            append_literal(out, out_len, &n, truncated, truncated + sizeof(truncated) - 1);
+            return;
+        }
+
+        memcpy(spec, conv.start, conv.len);
+        spec[conv.len] = '\0';
+
+        int written = 0;
+        switch (conv.kind) {
+            case ARG_INT:
+                written = EMIT_CONVERSION((int)(int64_t)value);
+                break;
+            case ARG_LONG:
+                written = EMIT_CONVERSION((long)(int64_t)value);
+                break;
+            case ARG_LLONG:
+                written = EMIT_CONVERSION((long long)value);
+                break;
+            case ARG_SIZE:
+                written = EMIT_CONVERSION((size_t)value);
+                break;
+            case ARG_DOUBLE: {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                written = EMIT_CONVERSION(d);
+                break;
+            }
+            case ARG_POINTER:
+                written = EMIT_CONVERSION((void*)(uintptr_t)value);
+                break;
+            default:
+                written = EMIT_CONVERSION(str);
+                break;
+        }
+        if (written > 0)
+            n = n + written < out_len ? n + written : out_len - 1;
+    }
+    append_literal(out, out_len, &n, p, p + strlen(p));
+}
+
+/**
+ * @brief Prints one record as a text log line.
+ * @return false if the record is malformed.
+ */
+static bool print_record(const BinLogHeader* hdr, const unsigned char* rec, size_t len, bool same_build) {
+    BinLogRecord fixed;
+    memcpy(&fixed, rec, sizeof(fixed));
+    size_t off = sizeof(fixed);
+
+    char tag[BINLOG_STRING_MAX + 1] = LOG_TAG;
+    if ((fixed.dest & BINLOG_CUSTOM_TAG) && !take_string(rec, len, &off, tag, sizeof(tag)))
+        return false;
+    int dest = fixed.dest & ~BINLOG_CUSTOM_TAG;
+
+    char message[BINLOG_TEXT_MAX];
+    if (fixed.fmt == BINLOG_RAW_FORMAT) {
+        if (!take_string(rec, len, &off, message, sizeof(message)))
+            return false;
+    } else {
+        const char* fmt = (const char*)(image.base + fixed.fmt);
+        int seg = same_build ? image_segment(&image, fmt) : -1;
+        if (seg >= 0 && strnlen(fmt, image.end[seg] - (uintptr_t)fmt) < image.end[seg] - (uintptr_t)fmt)
+            render_message(rec, len, off, fmt, message, sizeof(message));
+        else
+            snprintf(message, sizeof(message), "<format +0x%x from another build>", fixed.fmt);
+    }
+
+    char timestamp[48] = "[TimeError]";
+    int64_t wall_ns = (int64_t)fixed.mono_ns + hdr->realtime_offset_ns;
+    time_t sec = wall_ns / 1000000000LL;
+    struct tm tm;
+    if (localtime_r(&sec, &tm)) {
+        size_t n = strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &tm);
+        snprintf(timestamp + n, sizeof(timestamp) - n, ".%03d", (int)(wall_ns % 1000000000LL / 1000000));
+    }
+
+    printf("%s %s %s%s: %s\n", timestamp, level_str[fixed.level < LOG_FATAL ? fixed.level : LOG_FATAL], tag,
+           dest < LOG_DEST_COUNT ? dest_suffix[dest] : "", message);
+    return true;
+}
+
+/**
+ * @brief Renders a binary log file as text lines, oldest first.
+ * @note Must run from the same daemon build that wrote the records, formats are resolved against the
+ * executable doing the dump.
+ * @param argc Number of CLI arguments.
+ * @param argv Array of CLI argument strings, argv[2] optionally names the file.
+ * @return 0 on success, or 1 if the file is missing or invalid.
+ */
+int handle_logdump(int argc, char** argv) {
+    const char* path = argc > 2 ? argv[2] : BINLOG_FILE;
+    size_t map_len = BINLOG_DATA_OFFSET + BINLOG_DATA_SIZE;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < map_len) {
+        fprintf(stderr, "\033[31mERROR:\033[0m No binary log at %s\n", path);
+        if (fd >= 0)
+            close(fd);
+        return 1;
+    }
+
+    void* map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "\033[31mERROR:\033[0m Unable to map %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    const BinLogHeader* hdr = map;
+    const unsigned char* data = (const unsigned char*)map + BINLOG_DATA_OFFSET;
+    if (hdr->magic != BINLOG_MAGIC || hdr->version != BINLOG_VERSION || hdr->data_size != BINLOG_DATA_SIZE) {
+        fprintf(stderr, "\033[31mERROR:\033[0m %s is not an AZenith binary log\n", path);
+        munmap(map, map_len);
+        return 1;
+    }
+
+    bool same_build = load_image_info(&image) && strncmp(hdr->build_id, image.build_id, sizeof(hdr->build_id)) == 0;
+    if (!same_build)
+        fprintf(stderr, "\033[33mWARNING:\033[0m Log was written by another build, only preformatted lines decode\n");
+
+    uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    uint64_t pos = head > BINLOG_DATA_SIZE ? head - BINLOG_DATA_SIZE : 0;
+    int printed = 0, skipped = 0;
+
+    /* The oldest bytes may be the tail of an overwritten record, resync on 8-byte steps until pos matches */
+    while (pos + sizeof(BinLogRecord) <= head) {
+        unsigned char rec[BINLOG_RECORD_MAX] __attribute__((aligned(8)));
+        BinLogRecord fixed;
+        ring_read(data, pos, &fixed, sizeof(fixed));
+
+        if (fixed.pos != (uint32_t)pos || fixed.len < sizeof(fixed) || fixed.len > BINLOG_RECORD_MAX ||
+            fixed.len % 8 != 0 || pos + fixed.len > head) {
+            pos += 8;
+            skipped++;
+            continue;
+        }
+
+        ring_read(data, pos, rec, fixed.len);
+        if (print_record(hdr, rec, fixed.len, same_build))
+            printed++;
+        pos += fixed.len;
+    }
+
+    munmap(map, map_len);
+    fprintf(stderr, "%d records decoded%s\n", printed, skipped > 0 && head > BINLOG_DATA_SIZE ? ", ring wrapped" : "");
+    return 0;
+}
@@ -115,24 +115,138 @@ BypassNode bypass_list[] = {
     {"RESTRICTED_CHG_BATT", "/sys/class/power_supply/battery/restricted_charging", "1", "0"},
     {"RESTRICTED_CHG_WIRELESS", "/sys/class/power_supply/wireless/restricted_charging", "1", "0"}};
 
+static const BypassNode* active_node = NULL;
+static int active_fd = -1;
+static bool active_readable = false;
+static bool active_locked = false;
+static char active_value[16] = {0};
+static int active_error = 0;
+
 /**
  * @brief Writes a value to a sysfs/proc node and optionally sets it to read-only (chmod 0444) to
  * lock the value.
  * @param path Path to the sysfs or proc target file.
  * @param value String value to write.
  * @param lock Set to 1 to lock file as read-only, 0 to leave it writeable.
- * @return Status result of systemv execution.
+ * @return 0 if the value was written, -1 if the node is missing or the write failed.
  */
 int echo_to_file(const char* path, const char* value, int lock) {
     if (access(path, F_OK) != 0)
         return -1;
     chmod(path, 0644);
-    int res = systemv("echo '%s' > %s", value, path);
+
+    int res = -1;
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        char buf[32];
+        int len = snprintf(buf, sizeof(buf), "%s\n", value);
+        res = (write(fd, buf, len) == len) ? 0 : -1;
+        close(fd);
+    }
+
     if (lock)
         chmod(path, 0444);
     return res;
 }
 
+/**
+ * @brief Checks whether the active bypass node already holds the given value.
+ * @param value Value to compare against.
+ * @return true if the node (or the last value written when it cannot be read back) matches.
+ */
+static bool active_node_matches(const char* value) {
+    if (!active_readable)
+        return strcmp(active_value, value) == 0;
+
+    char cur[32] = {0};
+    ssize_t n = pread(active_fd, cur, sizeof(cur) - 1, 0);
+    if (n <= 0)
+        return false;
+    cur[strcspn(cur, "\n")] = '\0';
+    return strcmp(cur, value) == 0;
+}
+
+/**
+ * @brief Writes a value to the active bypass node through its cached file descriptor.
+ * @note Unchanged values are skipped, so repeated calls from the main loop cost a single pread.
+ * @param value String value to write.
+ * @param lock Set to 1 to leave the node read-only (0444), 0 to leave it writeable (0644).
+ * @return 0 on success or when the value already matches, -1 on write failure.
+ */
+static int write_active_node(const char* value, int lock) {
+    if (active_node_matches(value) && active_locked == (bool)lock)
+        return 0;
+
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%s\n", value);
+    if (pwrite(active_fd, buf, len, 0) != len) {
+        log_zenith(LOG_WARN, "Unable to write %s to %s", value, active_node->path);
+        return -1;
+    }
+
+    strncpy(active_value, value, sizeof(active_value) - 1);
+    active_value[sizeof(active_value) - 1] = '\0';
+
+    if (active_locked != (bool)lock) {
+        fchmod(active_fd, lock ? 0444 : 0644);
+        active_locked = lock;
+    }
+    return 0;
+}
+
+/**
+ * @brief Releases the previous bypass node and opens the named one.
+ * @param name Bypass node name from bypass_list (bypasspath config value).
+ * @return 0 on success, -1 if unsupported or unopenable, -2 if node not found in internal structure.
+ */
+static int open_bypass_node(const char* name) {
+    if (active_fd >= 0)
+        close(active_fd);
+    active_node = NULL;
+    active_fd = -1;
+    active_readable = false;
+    active_locked = false;
+    active_value[0] = '\0';
+
+    if (!name || strlen(name) == 0 || strcmp(name, "UNSUPPORTED") == 0)
+        return -1;
+
+    int total_nodes = sizeof(bypass_list) / sizeof(BypassNode);
+    for (int i = 0; i < total_nodes; i++) {
+        if (strcmp(bypass_list[i].name, name) != 0)
+            continue;
+
+        /* Open while writeable; the descriptor stays valid after the node is locked to 0444 */
+        chmod(bypass_list[i].path, 0644);
+        active_fd = open(bypass_list[i].path, O_RDWR | O_CLOEXEC);
+        active_readable = active_fd >= 0;
+        if (active_fd < 0)
+            active_fd = open(bypass_list[i].path, O_WRONLY | O_CLOEXEC);
+
+        if (active_fd < 0) {
+            log_zenith(LOG_WARN, "Unable to open bypass node %s (%s)", name, bypass_list[i].path);
+            return -1;
+        }
+
+        active_node = &bypass_list[i];
+        return 0;
+    }
+    return -2;
+}
+
+/**
+ * @brief Resolves the configured bypass node once and keeps its file descriptor open for later
+ * writes.
+ * @note Call whenever the bypasspath config changes; the previous node descriptor is released. A
+ * failure is remembered until the next call, so it is not retried and logged on every toggle.
+ * @param name Bypass node name from bypass_list (bypasspath config value).
+ * @return 0 on success, -1 if unsupported or unopenable, -2 if node not found in internal structure.
+ */
+int select_bypass_node(const char* name) {
+    active_error = open_bypass_node(name);
+    return active_error;
+}
+
 /**
  * @brief Checks the battery status via sysfs to determine if a power source is connected.
  * @return 1 if status is Charging or Full, 0 otherwise.
@@ -170,24 +284,29 @@ int read_current_ma() {
 }
 
 /**
- * @brief Retrieves the saved bypass path from system properties and restores the node to its normal
- * charging state.
+ * @brief Resolves the bypass node from system properties if none has been selected yet.
+ * @return 0 if a node is active, otherwise the select_bypass_node() error code.
  */
-void disable_bypass() {
-    char path_key[PROP_VALUE_MAX];
+static int ensure_active_node(void) {
+    if (active_node)
+        return 0;
+    if (active_error)
+        return active_error;
+
+    char path_key[PROP_VALUE_MAX] = {0};
     __system_property_get("persist.sys.azenithconf.bypasspath", path_key);
+    return select_bypass_node(path_key);
+}
 
-    if (strlen(path_key) == 0 || strcmp(path_key, "UNSUPPORTED") == 0)
+/**
+ * @brief Restores the active bypass node to its normal charging state.
+ */
+void disable_bypass() {
+    if (ensure_active_node() != 0)
         return;
 
-    int total_nodes = sizeof(bypass_list) / sizeof(BypassNode);
-    for (int i = 0; i < total_nodes; i++) {
-        if (strcmp(bypass_list[i].name, path_key) == 0) {
-            echo_to_file(bypass_list[i].path, bypass_list[i].off_val, 0);
-            log_zenith(LOG_INFO, "Bypass Charging Disabled");
-            return;
-        }
-    }
+    write_active_node(active_node->off_val, 0);
+    log_zenith(LOG_INFO, "Bypass Charging Disabled");
 }
 
 /**
@@ -196,20 +315,12 @@ void disable_bypass() {
  * @return 0 on success, -1 if unsupported, -2 if node not found in internal structure.
  */
 int enable_bypass() {
-    char path_key[PROP_VALUE_MAX];
-    __system_property_get("persist.sys.azenithconf.bypasspath", path_key);
+    int res = ensure_active_node();
+    if (res != 0)
+        return res;
 
-    if (strlen(path_key) == 0 || strcmp(path_key, "UNSUPPORTED") == 0)
-        return -1;
-
-    int total_nodes = sizeof(bypass_list) / sizeof(BypassNode);
-    for (int i = 0; i < total_nodes; i++) {
-        if (strcmp(bypass_list[i].name, path_key) == 0) {
-            echo_to_file(bypass_list[i].path, bypass_list[i].on_val, 1);
-            return 0;
-        }
-    }
-    return -2;
+    write_active_node(active_node->on_val, 1);
+    return 0;
 }
 
 /**
@@ -274,9 +385,9 @@ int check_bypass_compatibility() {
     __system_property_set("persist.sys.azenithconf.bypasspath", "UNSUPPORTED");
     __system_property_set("persist.sys.azenithconf.bypasschg", "0");
     __system_property_set("persist.sys.azenithconf.bypasschgthreshold", "20");
-    systemv("echo UNSUPPORTED > %s/bypasspath", BYPASSCHG_CONFIG);
-    systemv("echo 0 > %s/bypasschg", BYPASSCHG_CONFIG);
-    systemv("echo 20 > %s/bypasschgthreshold", BYPASSCHG_CONFIG);
+    write2file(BYPASSCHG_CONFIG "/bypasspath", false, false, "UNSUPPORTED\n");
+    write2file(BYPASSCHG_CONFIG "/bypasschg", false, false, "0\n");
+    write2file(BYPASSCHG_CONFIG "/bypasschgthreshold", false, false, "20\n");
     return 1;
 }
 
@@ -15,74 +15,370 @@
  */
 
 #include <AZenith.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdatomic.h>
+
+#define EXEC_MAX_RUNNING 16
+#define EXEC_REAP_POLL_MS 20
+#define EXEC_OUTPUT_CHUNK 512
+
+/* Process groups of the commands currently being waited for, 0 marks a free slot */
+static atomic_int running_groups[EXEC_MAX_RUNNING];
 
 /**
- * @brief Executes a shell command via Android standard shell and captures its standard output.
- * @note The caller is fully responsible for freeing the returned dynamically allocated string.
- * @param format Format string for the shell command, followed by variable arguments.
- * @return Pointer to the captured output string (trimmed), or NULL if the execution or fork fails.
+ * @struct ExecOutput
+ * @brief Where the stdout of a waited-for command goes.
+ * @note data grows as needed and is NUL-terminated. With on_line set, complete lines are handed to
+ * the callback and only the unfinished last line stays buffered.
  */
-char* execute_command(const char* format, ...) {
-    char command[MAX_COMMAND_LENGTH];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(command, sizeof(command), format, args);
-    va_end(args);
+typedef struct {
+    char* data;
+    size_t used;
+    size_t cap;
+    bool truncated;
+    void (*on_line)(char* line, void* arg);
+    void* arg;
+} ExecOutput;
 
-    int pipefd[2];
-    if (pipe(pipefd) == -1) [[clang::unlikely]] {
-        log_zenith(LOG_ERROR, "pipe failed in execute_command()");
-        return NULL;
+static void track_group(pid_t pid) {
+    for (int i = 0; i < EXEC_MAX_RUNNING; i++) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&running_groups[i], &expected, pid))
+            return;
     }
+}
 
-    pid_t pid = fork();
-    if (pid == -1) [[clang::unlikely]] {
-        close(pipefd[0]);
-        close(pipefd[1]);
-        log_zenith(LOG_ERROR, "fork failed in execute_command()");
-        return NULL;
+static void untrack_group(pid_t pid) {
+    for (int i = 0; i < EXEC_MAX_RUNNING; i++) {
+        int expected = pid;
+        if (atomic_compare_exchange_strong(&running_groups[i], &expected, 0))
+            return;
     }
+}
 
+/**
+ * @brief Kills every external command that is still being waited for.
+ * @note Async-signal-safe, the waiting threads see their command exit and report it as failed.
+ */
+void exec_cancel_all(void) {
+    for (int i = 0; i < EXEC_MAX_RUNNING; i++) {
+        pid_t pid = atomic_load(&running_groups[i]);
+        if (pid > 0)
+            kill(-pid, SIGKILL);
+    }
+}
+
+/**
+ * @brief Starts a program in its own process group without copying the daemon's address space.
+ * @note Uses vfork(), so the cost stays flat as the daemon's RSS grows. posix_spawn() would do the
+ * same but bionic only exports it from API 28.
+ * @param path Executable to run.
+ * @param argv Argument vector, NULL terminated.
+ * @param envp Environment of the child.
+ * @param fds Descriptors to install as stdin, stdout and stderr, -1 keeps the daemon's own. May be NULL.
+ * @return The child PID, or -1 if it could not be created.
+ */
+pid_t exec_spawn(const char* path, char* const argv[], char* const envp[], const int fds[3]) {
+    /* No signal handler may run on the stack the child borrows until execve */
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+
+    pid_t pid = vfork();
     if (pid == 0) {
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[0]);
-        close(pipefd[1]);
+        /* Own process group, so a timeout also takes down whatever the command started */
+        setpgid(0, 0);
+        for (int i = 0; fds && i < 3; i++) {
+            if (fds[i] >= 0)
+                dup2(fds[i], i);
+        }
+        /* The daemon ignores SIGPIPE, an ignored signal would stay ignored across execve */
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGPIPE, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &old, NULL);
 
-        char* env[] = {MY_PATH, NULL};
-        execle("/system/bin/sh", "sh", "-c", command, NULL, env);
+        execve(path, argv, envp);
         _exit(127);
     }
 
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return pid;
+}
+
+/**
+ * @brief Starts a program with its stdout connected to a pipe when output is wanted.
+ * @param out_fd Receives the non-blocking read end of the stdout pipe, or NULL to inherit stdout.
+ * @return The child PID, or -1 if the pipe or spawn failed.
+ */
+static pid_t spawn_process(const char* path, char* const argv[], char* const envp[], int* out_fd) {
+    if (!out_fd)
+        return exec_spawn(path, argv, envp, NULL);
+
+    int pipefd[2];
+    if (pipe2(pipefd, O_CLOEXEC) == -1) [[clang::unlikely]]
+        return -1;
+
+    pid_t pid = exec_spawn(path, argv, envp, (const int[3]){-1, pipefd[1], -1});
     close(pipefd[1]);
+    if (pid == -1) [[clang::unlikely]] {
+        close(pipefd[0]);
+        return -1;
+    }
+
+    fcntl(pipefd[0], F_SETFL, O_NONBLOCK);
+    *out_fd = pipefd[0];
+    return pid;
+}
 
-    char output[MAX_OUTPUT_LENGTH] = {0};
-    ssize_t total_read = 0;
+/**
+ * @brief Appends command output to the buffer and hands complete lines to the callback.
+ */
+static void append_output(ExecOutput* out, const char* chunk, size_t n) {
+    if (out->used + n + 1 > out->cap) {
+        size_t cap = out->cap ? out->cap : EXEC_OUTPUT_CHUNK;
+        while (out->used + n + 1 > cap)
+            cap *= 2;
+
+        char* grown = realloc(out->data, cap);
+        if (!grown) [[clang::unlikely]] {
+            out->truncated = true;
+            return;
+        }
+        out->data = grown;
+        out->cap = cap;
+    }
+
+    memcpy(out->data + out->used, chunk, n);
+    out->used += n;
+    out->data[out->used] = '\0';
+
+    if (!out->on_line)
+        return;
+
+    char* line = out->data;
+    char* end = out->data + out->used;
+    char* nl;
+    while ((nl = memchr(line, '\n', end - line))) {
+        *nl = '\0';
+        out->on_line(line, out->arg);
+        line = nl + 1;
+    }
+
+    out->used = end - line;
+    memmove(out->data, line, out->used + 1);
+}
+
+/**
+ * @brief Moves everything currently readable from a stdout pipe into the output sinks.
+ * @return false once the pipe reached EOF or failed.
+ */
+static bool drain_output(int fd, ExecOutput* out) {
+    char chunk[EXEC_OUTPUT_CHUNK];
     while (1) {
-        ssize_t bytes = read(pipefd[0], output + total_read, sizeof(output) - total_read - 1);
-        if (bytes <= 0)
-            break;
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno == EAGAIN;
+        if (n == 0)
+            return false;
+
+        append_output(out, chunk, n);
+    }
+}
+
+/**
+ * @brief Waits for a spawned command while draining its output, killing it once the deadline passes.
+ * @note Exit is noticed through a pidfd in poll(); kernels without pidfd_open fall back to polling waitpid().
+ * @param pid Child returned by spawn_process().
+ * @param out_fd Read end of its stdout pipe, or -1. Closed by this call.
+ * @param out Output sinks, or NULL.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @param what Command line, used in the timeout log message.
+ * @return The exit status of the command, -1 if it did not exit normally, or EXEC_TIMED_OUT.
+ */
+static int wait_process(pid_t pid, int out_fd, ExecOutput* out, int timeout_ms, const char* what) {
+    track_group(pid);
+
+    int pidfd = pidfd_of(pid);
+    uint64_t deadline = timeout_ms >= 0 ? exec_clock_ns() + (uint64_t)timeout_ms * 1000000ULL : UINT64_MAX;
+    bool timed_out = false;
+    int status = 0;
+    bool reaped = false;
 
-        total_read += bytes;
+    while (!reaped) {
+        struct pollfd pfds[2];
+        int nfds = 0;
+        if (out_fd >= 0)
+            pfds[nfds++] = (struct pollfd){.fd = out_fd, .events = POLLIN};
+        if (pidfd >= 0)
+            pfds[nfds++] = (struct pollfd){.fd = pidfd, .events = POLLIN};
 
-        if (total_read >= (ssize_t)(sizeof(output) - 1))
+        int wait_ms = -1;
+        if (deadline != UINT64_MAX) {
+            uint64_t now = exec_clock_ns();
+            if (now >= deadline) {
+                timed_out = true;
+                break;
+            }
+            wait_ms = (int)((deadline - now + 999999) / 1000000);
+        }
+        if (pidfd < 0 && (wait_ms < 0 || wait_ms > EXEC_REAP_POLL_MS))
+            wait_ms = EXEC_REAP_POLL_MS;
+
+        if (poll(pfds, nfds, wait_ms) < 0 && errno != EINTR) [[clang::unlikely]]
             break;
+
+        if (out_fd >= 0 && pfds[0].revents && !drain_output(out_fd, out)) {
+            close(out_fd);
+            out_fd = -1;
+        }
+
+        pid_t ret = waitpid(pid, &status, WNOHANG);
+        if (ret == pid || (ret == -1 && errno == ECHILD))
+            reaped = true;
+    }
+
+    if (!reaped) {
+        kill(-pid, SIGKILL);
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+    }
+
+    /* Pick up what the command wrote right before it exited, without waiting for its background children */
+    if (out_fd >= 0) {
+        drain_output(out_fd, out);
+        close(out_fd);
+    }
+    if (out && out->on_line && out->used > 0) {
+        out->on_line(out->data, out->arg);
+        out->used = 0;
     }
-    close(pipefd[0]);
+    if (out && out->truncated)
+        log_zenith(LOG_WARN, "Out of memory, output of %s was cut short", what);
+    if (pidfd >= 0)
+        close(pidfd);
+    untrack_group(pid);
+
+    if (timed_out) {
+        log_zenith(LOG_WARN, "Command timed out after %d ms and was killed: %s", timeout_ms, what);
+        return EXEC_TIMED_OUT;
+    }
+    if (reaped && WIFEXITED(status))
+        return WEXITSTATUS(status);
+    return -1;
+}
 
-    int status;
-    waitpid(pid, &status, 0);
-    if (WEXITSTATUS(status))
+/**
+ * @brief Runs a shell command in a freshly spawned shell.
+ * @param command Fully formatted shell command.
+ * @param out Output sinks, or NULL to leave stdout alone.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @param path How the command is accounted in the exec statistics.
+ * @return The exit status of the command, -1 on failure, or EXEC_TIMED_OUT.
+ */
+static int run_shell(const char* command, ExecOutput* out, int timeout_ms, ExecPath path) {
+    char* argv[] = {"sh", "-c", (char*)command, NULL};
+    char* env[] = {MY_PATH, NULL};
+    int out_fd = -1;
+
+    uint64_t start = exec_clock_ns();
+    pid_t pid = spawn_process("/system/bin/sh", argv, env, out ? &out_fd : NULL);
+    uint64_t spawned = exec_clock_ns();
+    if (pid == -1) [[clang::unlikely]] {
+        log_zenith(LOG_ERROR, "spawn failed for: %s", command);
+        exec_stats_record(command, path, spawned - start, 0, true);
+        return -1;
+    }
+
+    int status = wait_process(pid, out_fd, out, timeout_ms, command);
+    exec_stats_record(command, path, spawned - start, exec_clock_ns() - spawned, status != 0);
+    return status;
+}
+
+/**
+ * @brief Turns captured output into the result of execute_command() and execute_direct().
+ * @param output Captured output, may be NULL if the command printed nothing. Consumed.
+ * @param status Exit status of the command.
+ * @return The trimmed output, or NULL if the command failed.
+ */
+static char* finish_output(char* output, int status) {
+    if (status != 0) {
+        free(output);
         return NULL;
+    }
+    if (!output)
+        return strdup("");
+    return trim_newline(output);
+}
+
+/**
+ * @brief Executes a shell command and captures its standard output, giving up after a deadline.
+ * @note Runs on a persistent shell pool worker when available, spawning a new shell otherwise.
+ * @note Output is captured in full, there is no length limit.
+ * @note Latency is accounted in the exec statistics under the command's key.
+ * @note The caller is fully responsible for freeing the returned dynamically allocated string.
+ * @param timeout_ms Deadline in milliseconds, the command's process group is killed once it passes.
+ * @param format Format string for the shell command, followed by variable arguments.
+ * @return Pointer to the captured output string (trimmed), or NULL if the command failed or timed out.
+ */
+static char* execute_command_va(int timeout_ms, const char* format, va_list args) {
+    char command[MAX_COMMAND_LENGTH];
+    vsnprintf(command, sizeof(command), format, args);
+
+    char* output = NULL;
+    uint64_t start = exec_clock_ns();
+    int status = shell_pool_run(command, &output, timeout_ms);
+    if (status != SHELL_POOL_UNAVAILABLE) [[clang::likely]] {
+        exec_stats_record(command, EXEC_POOL, 0, exec_clock_ns() - start, status != 0);
+    } else {
+        ExecOutput out = {0};
+        status = run_shell(command, &out, timeout_ms, EXEC_FORK);
+        output = out.data;
+    }
 
-    return strdup(trim_newline(output));
+    return finish_output(output, status);
+}
+
+/**
+ * @brief Executes a shell command via Android standard shell and captures its standard output.
+ * @note Gives up after EXEC_TIMEOUT_MS, see execute_command_timeout().
+ * @note The caller is fully responsible for freeing the returned dynamically allocated string.
+ * @param format Format string for the shell command, followed by variable arguments.
+ * @return Pointer to the captured output string (trimmed), or NULL if the command fails or times out.
+ */
+char* execute_command(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char* output = execute_command_va(EXEC_TIMEOUT_MS, format, args);
+    va_end(args);
+    return output;
+}
+
+/**
+ * @brief Executes a shell command and captures its standard output, giving up after a deadline.
+ * @note The caller is fully responsible for freeing the returned dynamically allocated string.
+ * @param timeout_ms Deadline in milliseconds, the command's process group is killed once it passes.
+ * @param format Format string for the shell command, followed by variable arguments.
+ * @return Pointer to the captured output string (trimmed), or NULL if the command failed or timed out.
+ */
+char* execute_command_timeout(int timeout_ms, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char* output = execute_command_va(timeout_ms, format, args);
+    va_end(args);
+    return output;
 }
 
 /**
  * @brief Executes a binary directly without spawning a shell and captures its standard output.
+ * @note Gives up after EXEC_TIMEOUT_MS and kills the program's process group.
  * @note The caller is fully responsible for freeing the returned dynamically allocated string.
  * @param path Absolute path to the executable binary.
  * @param arg0 The first argument passed to the program (typically the program name itself).
- * @return Pointer to the captured output string (trimmed), or NULL if execution or fork fails.
+ * @return Pointer to the captured output string (trimmed), or NULL if execution or spawn fails.
  */
 char* execute_direct(const char* path, const char* arg0, ...) {
     /* Supports up to 15 arguments + NULL */
@@ -99,85 +395,92 @@ char* execute_direct(const char* path, const char* arg0, ...) {
     argv[argc] = NULL;
     va_end(args);
 
-    int pipefd[2];
-    if (pipe(pipefd) == -1) [[clang::unlikely]] {
-        log_zenith(LOG_ERROR, "pipe failed in execute_direct()");
-        return NULL;
-    }
 
-    pid_t pid = fork();
+    ExecOutput out = {0};
+    int out_fd = -1;
+
+    uint64_t start = exec_clock_ns();
+    pid_t pid = spawn_process(path, (char* const*)argv, environ, &out_fd);
+    uint64_t spawned = exec_clock_ns();
     if (pid == -1) [[clang::unlikely]] {
-        close(pipefd[0]);
-        close(pipefd[1]);
-        log_zenith(LOG_ERROR, "fork failed in execute_direct()");
+        log_zenith(LOG_ERROR, "spawn failed in execute_direct()");
+        exec_stats_record(path, EXEC_DIRECT, spawned - start, 0, true);
         return NULL;
     }
 
-    if (pid == 0) {
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[0]);
-        close(pipefd[1]);
-
-        execv(path, (char* const*)argv);
-        _exit(127);
-    }
-
-    close(pipefd[1]);
-
-    char output[MAX_OUTPUT_LENGTH] = {0};
-    ssize_t total_read = 0;
-    while (1) {
-        ssize_t bytes = read(pipefd[0], output + total_read, sizeof(output) - total_read - 1);
-        if (bytes <= 0)
-            break;
-
-        total_read += bytes;
-
-        if (total_read >= (ssize_t)(sizeof(output) - 1))
-            break;
-    }
-    close(pipefd[0]);
-
-    int status;
-    waitpid(pid, &status, 0);
-    if (WEXITSTATUS(status))
-        return NULL;
-
-    return strdup(trim_newline(output));
+    int status = wait_process(pid, out_fd, &out, EXEC_TIMEOUT_MS, path);
+    exec_stats_record(path, EXEC_DIRECT, spawned - start, exec_clock_ns() - spawned, status != 0);
+    return finish_output(out.data, status);
 }
 
 /**
- * @brief Executes a shell command using a formatted string, mimicking standard system() behavior.
+ * @brief Runs a shell command in its own process and hands every line of its output to a callback.
+ * @note Never goes through the shell pool, only the line being read is buffered.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @param on_line Called with each NUL-terminated line, without its newline.
+ * @param arg Passed through to on_line.
  * @param format Format string for the shell command, followed by variable arguments.
- * @return The exit status code of the command (WEXITSTATUS), or -1 if fork/execution fails.
+ * @return The exit status of the command, -1 on failure, or EXEC_TIMED_OUT.
  */
-int systemv(const char* format, ...) {
+int exec_stream(int timeout_ms, void (*on_line)(char* line, void* arg), void* arg, const char* format, ...) {
     char command[MAX_COMMAND_LENGTH];
     va_list args;
     va_start(args, format);
     vsnprintf(command, sizeof(command), format, args);
     va_end(args);
 
-    pid_t pid = fork();
-    if (pid == -1) [[clang::unlikely]] {
-        log_zenith(LOG_ERROR, "fork failed in systemv()");
-        return -1;
-    }
+    ExecOutput out = {.on_line = on_line, .arg = arg};
+    int status = run_shell(command, &out, timeout_ms, EXEC_STREAM);
+    free(out.data);
+    return status;
+}
 
-    if (pid == 0) {
-        char* env[] = {MY_PATH, NULL};
-        execle("/system/bin/sh", "sh", "-c", command, NULL, env);
+/**
+ * @brief Executes a shell command with a deadline, mimicking standard system() behavior.
+ * @param timeout_ms Deadline in milliseconds, the command's process group is killed once it passes.
+ * @param format Format string for the shell command.
+ * @param args Format arguments.
+ * @return The exit status of the command, -1 if spawn/execution fails, or EXEC_TIMED_OUT.
+ */
+static int systemv_va(int timeout_ms, const char* format, va_list args) {
+    char command[MAX_COMMAND_LENGTH];
+    vsnprintf(command, sizeof(command), format, args);
 
-        /* If exec fails */
-        _exit(127);
+    uint64_t start = exec_clock_ns();
+    int status = shell_pool_run(command, NULL, timeout_ms);
+    if (status != SHELL_POOL_UNAVAILABLE) [[clang::likely]] {
+        exec_stats_record(command, EXEC_POOL, 0, exec_clock_ns() - start, status != 0);
+        return status;
     }
 
-    int status;
-    if (waitpid(pid, &status, 0) == -1)
-        return -1;
+    return run_shell(command, NULL, timeout_ms, EXEC_FORK);
+}
 
-    if (WIFEXITED(status))
-        return WEXITSTATUS(status);
+/**
+ * @brief Executes a shell command using a formatted string, mimicking standard system() behavior.
+ * @note Runs on a persistent shell pool worker when available, spawning a new shell otherwise.
+ * @note Gives up after EXEC_TIMEOUT_MS, see systemv_timeout().
+ * @param format Format string for the shell command, followed by variable arguments.
+ * @return The exit status of the command (WEXITSTATUS), -1 if spawn/execution fails, or EXEC_TIMED_OUT.
+ */
+int systemv(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int status = systemv_va(EXEC_TIMEOUT_MS, format, args);
+    va_end(args);
+    return status;
+}
 
-    return -1;
+/**
+ * @brief Executes a shell command like systemv(), killing it once the deadline passes.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @param format Format string for the shell command, followed by variable arguments.
+ * @return The exit status of the command (WEXITSTATUS), -1 if spawn/execution fails, or EXEC_TIMED_OUT.
+ */
+int systemv_timeout(int timeout_ms, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int status = systemv_va(timeout_ms, format, args);
+    va_end(args);
+    return status;
 }
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define CONTROL_SOCKET_NAME "azenith.control"
+#define CONTROL_MAGIC 0x4C54435Au /* "ZCTL" */
+#define CONTROL_VERSION 3
+#define CONTROL_SERVER_TIMEOUT_MS 200
+#define CONTROL_CLIENT_TIMEOUT_S 60
+
+/**
+ * @brief Fills the abstract socket address of the control socket.
+ * @return Length of the address to pass to bind() or connect().
+ */
+static socklen_t control_address(struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    /* Abstract namespace: no file to label or clean up, access is checked with SO_PEERCRED */
+    memcpy(addr->sun_path + 1, CONTROL_SOCKET_NAME, sizeof(CONTROL_SOCKET_NAME) - 1);
+    return offsetof(struct sockaddr_un, sun_path) + 1 + sizeof(CONTROL_SOCKET_NAME) - 1;
+}
+
+/**
+ * @brief Applies send and receive timeouts to a socket.
+ */
+static void set_socket_timeout(int fd, time_t sec, suseconds_t usec) {
+    struct timeval tv = {.tv_sec = sec, .tv_usec = usec};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/**
+ * @brief Creates the daemon's control socket.
+ * @return Non-blocking listening socket to add to the poll set, or -1 on failure.
+ */
+int control_socket_open(void) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_un addr;
+    socklen_t len = control_address(&addr);
+    if (bind(fd, (struct sockaddr*)&addr, len) != 0 || listen(fd, 8) != 0) {
+        log_zenith(LOG_WARN, "Control socket unavailable (%s), CLI commands run standalone", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    log_zenith(LOG_INFO, "Listening for CLI requests on control socket");
+    return fd;
+}
+
+/**
+ * @brief Accepts the next pending client and reads its request.
+ * @note Clients that are not root or send a malformed request are dropped.
+ * @param listen_fd Socket returned by control_socket_open().
+ * @param req Destination for the request.
+ * @return Connected client socket to answer with control_socket_reply(), or -1 when no client is
+ * pending.
+ */
+int control_socket_accept(int listen_fd, ControlRequest* req) {
+    for (;;) {
+        int client = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0)
+            return -1;
+
+        struct ucred cred = {.uid = (uid_t)-1};
+        socklen_t cred_len = sizeof(cred);
+        if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) != 0 || cred.uid != 0) {
+            log_zenith(LOG_WARN, "Rejected control request from uid %d", (int)cred.uid);
+            close(client);
+            continue;
+        }
+
+        /* A client that connects and stalls must not hold up the main loop */
+        set_socket_timeout(client, 0, CONTROL_SERVER_TIMEOUT_MS * 1000);
+
+        ssize_t n = recv(client, req, sizeof(*req), 0);
+        if (n != (ssize_t)sizeof(*req) || req->magic != CONTROL_MAGIC || req->version != CONTROL_VERSION) {
+            close(client);
+            continue;
+        }
+
+        return client;
+    }
+}
+
+/**
+ * @brief Sends one line of a multi-line answer, the request still needs control_socket_reply().
+ * @param client Socket returned by control_socket_accept().
+ * @param fmt Format string for the line printed by the CLI.
+ */
+void control_socket_send(int client, const char* fmt, ...) {
+    ControlResponse resp = {.more = 1};
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(resp.text, sizeof(resp.text), fmt, args);
+    va_end(args);
+
+    send(client, &resp, sizeof(resp), MSG_NOSIGNAL);
+}
+
+/**
+ * @brief Sends the response to a control request and closes the client socket.
+ * @param client Socket returned by control_socket_accept().
+ * @param status 0 on success, non-zero on failure.
+ * @param fmt Format string for the message shown by the CLI, may be empty.
+ */
+void control_socket_reply(int client, int status, const char* fmt, ...) {
+    ControlResponse resp = {.status = status};
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(resp.text, sizeof(resp.text), fmt, args);
+    va_end(args);
+
+    send(client, &resp, sizeof(resp), MSG_NOSIGNAL);
+    close(client);
+}
+
+/**
+ * @brief Sends a request to the running daemon and waits until it has been carried out.
+ * @note Lines sent ahead of the answer with control_socket_send() are printed to stdout as they arrive.
+ * @param req Request to send, magic and version are filled in.
+ * @param resp Destination for the daemon's response.
+ * @return 0 if the daemon answered, CONTROL_UNREACHABLE if the request never reached it, or
+ * CONTROL_NO_ANSWER if it was delivered but the daemon timed out or died before answering.
+ */
+int control_request(ControlRequest* req, ControlResponse* resp) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return CONTROL_UNREACHABLE;
+
+    struct sockaddr_un addr;
+    socklen_t len = control_address(&addr);
+    if (connect(fd, (struct sockaddr*)&addr, len) != 0) {
+        close(fd);
+        return CONTROL_UNREACHABLE;
+    }
+
+    /* Profile scripts can take a while, the daemon answers once they are done */
+    set_socket_timeout(fd, CONTROL_CLIENT_TIMEOUT_S, 0);
+
+    req->magic = CONTROL_MAGIC;
+    req->version = CONTROL_VERSION;
+    int ret = CONTROL_UNREACHABLE;
+    if (send(fd, req, sizeof(*req), MSG_NOSIGNAL) == (ssize_t)sizeof(*req)) {
+        ret = CONTROL_NO_ANSWER;
+        while (recv(fd, resp, sizeof(*resp), 0) == (ssize_t)sizeof(*resp)) {
+            resp->text[sizeof(resp->text) - 1] = '\0';
+            if (!resp->more) {
+                ret = 0;
+                break;
+            }
+            printf("%s\n", resp->text);
+        }
+    }
+
+    close(fd);
+    return ret;
+}
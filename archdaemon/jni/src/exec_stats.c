@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+
+#define EXEC_STATS_KEYS 48
+#define EXEC_STATS_KEY_LEN 48
+#define EXEC_STATS_SUB_BITS 3
+#define EXEC_STATS_SUB (1 << EXEC_STATS_SUB_BITS)
+#define EXEC_STATS_BUCKETS 208 /* 8 sub-buckets per power of two, up to ~134 s in microseconds */
+
+/**
+ * @struct ExecStat
+ * @brief Latency histogram and totals of every external command sharing one key.
+ */
+typedef struct {
+    char key[EXEC_STATS_KEY_LEN];
+    uint32_t count;
+    uint32_t failed;
+    uint32_t paths[EXEC_PATH_COUNT];
+    uint64_t total_ns;
+    uint64_t spawn_ns;
+    uint64_t wait_ns;
+    uint64_t max_ns;
+    uint32_t buckets[EXEC_STATS_BUCKETS];
+} ExecStat;
+
+static ExecStat stats[EXEC_STATS_KEYS];
+static int stats_used = 0;
+static uint32_t stats_dropped = 0;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* const path_names[EXEC_PATH_COUNT] = {
+    [EXEC_POOL] = "pool",
+    [EXEC_FORK] = "fork",
+    [EXEC_DIRECT] = "direct",
+    [EXEC_STREAM] = "stream",
+    [EXEC_WORKER] = "worker",
+};
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds.
+ */
+uint64_t exec_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Reduces a command line to the key its latency is accounted under.
+ * @note The key is the program's basename plus its first plain-word argument, so
+ * "/system/bin/cmd power set-mode 1" and "cmd power set-mode 0" share "cmd power".
+ * @param command Shell command or program path.
+ * @param key Destination buffer of EXEC_STATS_KEY_LEN bytes.
+ */
+static void command_key(const char* command, char* key) {
+    const char* p = command;
+    while (*p && isspace((unsigned char)*p))
+        p++;
+
+    const char* start = p;
+    while (*p && !isspace((unsigned char)*p)) {
+        if (*p == '/')
+            start = p + 1;
+        p++;
+    }
+
+    size_t len = p - start;
+    if (len >= EXEC_STATS_KEY_LEN)
+        len = EXEC_STATS_KEY_LEN - 1;
+    memcpy(key, start, len);
+
+    while (*p && isspace((unsigned char)*p))
+        p++;
+
+    /* Only a bare word is useful for grouping, paths, quotes and options are per-call values */
+    size_t arg_len = 0;
+    while (isalnum((unsigned char)p[arg_len]) || p[arg_len] == '_' || p[arg_len] == '-' || p[arg_len] == '.')
+        arg_len++;
+    bool bare = arg_len > 0 && (!p[arg_len] || isspace((unsigned char)p[arg_len]));
+    if (bare && p[0] != '-' && !isdigit((unsigned char)p[0]) && len + 1 + arg_len < EXEC_STATS_KEY_LEN) {
+        key[len++] = ' ';
+        memcpy(key + len, p, arg_len);
+        len += arg_len;
+    }
+
+    key[len] = '\0';
+    if (len == 0)
+        strcpy(key, "(empty)");
+}
+
+/**
+ * @brief Maps a latency to its histogram bucket.
+ * @param us Latency in microseconds.
+ */
+static int bucket_of(uint64_t us) {
+    if (us < EXEC_STATS_SUB)
+        return (int)us;
+
+    int octave = 63 - __builtin_clzll(us);
+    int sub = (int)(us >> (octave - EXEC_STATS_SUB_BITS)) & (EXEC_STATS_SUB - 1);
+    int bucket = (octave - EXEC_STATS_SUB_BITS + 1) * EXEC_STATS_SUB + sub;
+    return bucket < EXEC_STATS_BUCKETS ? bucket : EXEC_STATS_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns the largest latency in microseconds that falls into a histogram bucket.
+ */
+static uint64_t bucket_limit(int bucket) {
+    if (bucket < EXEC_STATS_SUB)
+        return bucket;
+
+    int octave = bucket / EXEC_STATS_SUB + EXEC_STATS_SUB_BITS - 1;
+    uint64_t step = 1ULL << (octave - EXEC_STATS_SUB_BITS);
+    return (uint64_t)(EXEC_STATS_SUB + bucket % EXEC_STATS_SUB) * step + step - 1;
+}
+
+/**
+ * @brief Estimates a latency percentile from a histogram.
+ * @param s Entry to read.
+ * @param pct Percentile between 0 and 100.
+ * @return Upper bound of the bucket holding the percentile in nanoseconds, capped at the maximum seen.
+ */
+static uint64_t percentile_ns(const ExecStat* s, unsigned int pct) {
+    uint64_t rank = ((uint64_t)s->count * pct + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < EXEC_STATS_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen >= rank && seen > 0) {
+            uint64_t ns = bucket_limit(i) * 1000 + 999;
+            return ns < s->max_ns ? ns : s->max_ns;
+        }
+    }
+    return s->max_ns;
+}
+
+/**
+ * @brief Finds or creates the entry of a key.
+ * @note Caller must hold stats_mutex. Linear search is fine for the few dozen distinct commands the
+ * daemon runs.
+ * @return The entry, or NULL once every slot is taken.
+ */
+static ExecStat* find_entry(const char* key) {
+    for (int i = 0; i < stats_used; i++) {
+        if (strcmp(stats[i].key, key) == 0)
+            return &stats[i];
+    }
+
+    if (stats_used == EXEC_STATS_KEYS)
+        return NULL;
+
+    ExecStat* s = &stats[stats_used++];
+    memset(s, 0, sizeof(*s));
+    strcpy(s->key, key);
+    return s;
+}
+
+/**
+ * @brief Accounts one finished external command.
+ * @param command Command line or program path the command was started with.
+ * @param path How the command was started.
+ * @param spawn_ns Time spent creating the process (pipe, fork), 0 for pool and warm profile workers.
+ * @param wait_ns Time from the process being started until its exit was collected.
+ * @param failed Set to true if the command could not be run or exited non-zero.
+ */
+void exec_stats_record(const char* command, ExecPath path, uint64_t spawn_ns, uint64_t wait_ns, bool failed) {
+    char key[EXEC_STATS_KEY_LEN];
+    command_key(command, key);
+
+    uint64_t total = spawn_ns + wait_ns;
+
+    pthread_mutex_lock(&stats_mutex);
+    ExecStat* s = find_entry(key);
+    if (!s) [[clang::unlikely]] {
+        stats_dropped++;
+        pthread_mutex_unlock(&stats_mutex);
+        return;
+    }
+
+    s->count++;
+    if (failed)
+        s->failed++;
+    s->paths[path]++;
+    s->total_ns += total;
+    s->spawn_ns += spawn_ns;
+    s->wait_ns += wait_ns;
+    if (total > s->max_ns)
+        s->max_ns = total;
+    s->buckets[bucket_of(total / 1000)]++;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+static int compare_total(const void* a, const void* b) {
+    const ExecStat* x = a;
+    const ExecStat* y = b;
+    return (x->total_ns < y->total_ns) - (x->total_ns > y->total_ns);
+}
+
+/**
+ * @brief Sends the collected statistics to a control socket client, slowest commands first.
+ * @param client Socket returned by control_socket_accept(), answered and closed by this call.
+ * @param reset Set to true to clear the statistics after they were copied.
+ */
+void exec_stats_report(int client, bool reset) {
+    static ExecStat snapshot[EXEC_STATS_KEYS];
+
+    pthread_mutex_lock(&stats_mutex);
+    int used = stats_used;
+    uint32_t dropped = stats_dropped;
+    memcpy(snapshot, stats, sizeof(ExecStat) * used);
+    if (reset) {
+        stats_used = 0;
+        stats_dropped = 0;
+    }
+    pthread_mutex_unlock(&stats_mutex);
+
+    if (used == 0) {
+        control_socket_reply(client, 0, "No external commands recorded yet");
+        return;
+    }
+
+    qsort(snapshot, used, sizeof(ExecStat), compare_total);
+
+    control_socket_send(client, "%-44s %6s %5s %9s %9s %9s %9s %9s %10s  %s", "COMMAND", "CALLS", "FAIL", "P50 ms",
+                        "P95 ms", "MAX ms", "SPAWN ms", "WAIT ms", "TOTAL ms", "VIA");
+
+    uint64_t total_ns = 0;
+    uint32_t total_calls = 0;
+    for (int i = 0; i < used; i++) {
+        const ExecStat* s = &snapshot[i];
+        char via[64] = {0};
+        size_t via_len = 0;
+        for (int p = 0; p < EXEC_PATH_COUNT; p++) {
+            if (s->paths[p] && via_len < sizeof(via))
+                via_len += snprintf(via + via_len, sizeof(via) - via_len, "%s%s:%u", via_len ? " " : "", path_names[p],
+                                    s->paths[p]);
+        }
+
+        /* Spawn and wait are per-call averages, the columns before them are per-call latencies */
+        control_socket_send(client, "%-44s %6u %5u %9.2f %9.2f %9.2f %9.3f %9.2f %10.1f  %s", s->key, s->count, s->failed,
+                            percentile_ns(s, 50) / 1e6, percentile_ns(s, 95) / 1e6, s->max_ns / 1e6,
+                            s->spawn_ns / 1e6 / s->count, s->wait_ns / 1e6 / s->count, s->total_ns / 1e6, via);
+        total_ns += s->total_ns;
+        total_calls += s->count;
+    }
+
+    control_socket_reply(client, 0, "%u calls across %d commands, %.1f ms total%s", total_calls, used, total_ns / 1e6,
+                         dropped ? " (some commands not tracked, table full)" : "");
+}
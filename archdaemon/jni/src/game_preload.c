@@ -19,33 +19,74 @@
 #include <string.h>
 #include <sys/system_properties.h>
 
+/**
+ * @struct PreloadProgress
+ * @brief Totals collected from the preloadbin output.
+ */
+typedef struct {
+    int total_pages;
+    char total_size[32];
+} PreloadProgress;
+
+/**
+ * @brief Handles one line of preloadbin output.
+ * @param line Output line without its newline.
+ * @param arg Pointer to the PreloadProgress of the running preload.
+ */
+static void on_preload_line(char* line, void* arg) {
+    PreloadProgress* progress = arg;
+
+    char* p_pages = strstr(line, "Touched Pages:");
+    if (p_pages) {
+        int pages = 0;
+        char size[32] = {0};
+
+        if (sscanf(p_pages, "Touched Pages: %d (%31[^)])", &pages, size) == 2) {
+            progress->total_pages += pages;
+            strncpy(progress->total_size, size, sizeof(progress->total_size) - 1);
+            progress->total_size[sizeof(progress->total_size) - 1] = '\0';
+
+            log_zenith(LOG_DEBUG, "Preloading complete: %d memory pages touched", pages);
+            log_zenith(LOG_DEBUG, "Total memory used for preloaded libraries: %s", size);
+        } else {
+            log_zenith(LOG_WARN, "Failed to parse Touched Pages");
+        }
+        return;
+    }
+
+    char* ext = strrchr(line, '.');
+    if (ext) {
+        if (strcmp(ext, ".so") == 0 || strcmp(ext, ".apk") == 0 || strcmp(ext, ".dm") == 0 ||
+            strcmp(ext, ".odex") == 0 || strcmp(ext, ".vdex") == 0 ||
+            strcmp(ext, ".art") == 0) {
+            log_preload(LOG_DEBUG, "Touched: %s", line);
+        }
+    }
+}
+
 /**
  * @brief Preloads all native libraries (.so) or split APKs inside the target application into
  * memory.
+ * @note Gives up after EXEC_PRELOAD_TIMEOUT_MS so a stuck preloadbin cannot pin the thread. The
+ * main loop starts it PRELOAD_DELAY_MS after the game launched.
  * @param package Target application package name.
  */
 void GamePreload(const char* package) {
-    sleep(5);
-
     if (!package || package[0] == '\0') {
         log_zenith(LOG_WARN, "Package is null or empty");
         return;
     }
 
-    char apk_path[256] = {0};
-    char cmd_apk[512];
-    snprintf(cmd_apk, sizeof(cmd_apk), "cmd package path %s | head -n1 | cut -d: -f2", package);
-
-    FILE* apk = popen(cmd_apk, "r");
-    if (!apk || !fgets(apk_path, sizeof(apk_path), apk)) {
+    char* apk = execute_command("cmd package path %s | head -n1 | cut -d: -f2", package);
+    if (!apk || !apk[0]) {
         log_zenith(LOG_WARN, "Failed to get APK path for %s", package);
-        if (apk)
-            pclose(apk);
+        free(apk);
         return;
     }
-    pclose(apk);
 
-    apk_path[strcspn(apk_path, "\n")] = 0;
+    char apk_path[256] = {0};
+    snprintf(apk_path, sizeof(apk_path), "%s", apk);
+    free(apk);
 
     char* last_slash = strrchr(apk_path, '/');
     if (!last_slash) {
@@ -71,64 +112,30 @@ void GamePreload(const char* package) {
         closedir(dir);
     }
 
-    char budget[32] = {0};
-    if (__system_property_get("persist.sys.azenithconf.preloadbudget", budget) <= 0) {
+    char budget[PROP_VALUE_MAX] = {0};
+    if (prop_cache_get(PROP_PRELOADBUDGET, budget) <= 0) {
         strcpy(budget, "500M");
     }
 
     const char* target_path = lib_exists ? lib_path : apk_path;
     const char* target_type = lib_exists ? "libs" : "split apks";
 
-    char preload_cmd[512];
-    snprintf(preload_cmd, sizeof(preload_cmd), "sys.azenith-preloadbin -v -t -m %s \"%s\"", budget,
-             target_path);
-
-    FILE* fp = popen(preload_cmd, "r");
-    if (!fp) {
-        log_zenith(LOG_WARN, "Failed to run preloadbin for %s", package);
-        return;
-    }
-
     log_zenith(LOG_INFO, "Preloading game %s %s", target_type, package);
     log_preload(LOG_INFO, "Preloading %s %s with budget %s", target_type, target_path, budget);
 
-    char line[1024];
-    int total_pages = 0;
-    char total_size[32] = {0};
-
-    while (fgets(line, sizeof(line), fp)) {
-        line[strcspn(line, "\n")] = 0;
-
-        char* p_pages = strstr(line, "Touched Pages:");
-        if (p_pages) {
-            int pages = 0;
-            char size[32] = {0};
-
-            if (sscanf(p_pages, "Touched Pages: %d (%31[^)])", &pages, size) == 2) {
-                total_pages += pages;
-                strncpy(total_size, size, sizeof(total_size) - 1);
-                total_size[sizeof(total_size) - 1] = '\0';
-
-                log_zenith(LOG_DEBUG, "Preloading complete: %d memory pages touched", pages);
-                log_zenith(LOG_DEBUG, "Total memory used for preloaded libraries: %s", size);
-            } else {
-                log_zenith(LOG_WARN, "Failed to parse Touched Pages");
-            }
-            continue;
-        }
-
-        char* ext = strrchr(line, '.');
-        if (ext) {
-            if (strcmp(ext, ".so") == 0 || strcmp(ext, ".apk") == 0 || strcmp(ext, ".dm") == 0 ||
-                strcmp(ext, ".odex") == 0 || strcmp(ext, ".vdex") == 0 ||
-                strcmp(ext, ".art") == 0) {
-                log_preload(LOG_DEBUG, "Touched: %s", line);
-            }
-        }
+    PreloadProgress progress = {0};
+    int status = exec_stream(EXEC_PRELOAD_TIMEOUT_MS, on_preload_line, &progress,
+                             "sys.azenith-preloadbin -v -t -m %s \"%s\"", budget, target_path);
+    if (status == EXEC_TIMED_OUT) {
+        log_preload(LOG_WARN, "Preloading %s timed out after %d ms: %d pages touched", package,
+                    EXEC_PRELOAD_TIMEOUT_MS, progress.total_pages);
+        return;
+    }
+    if (status == -1) {
+        log_zenith(LOG_WARN, "Failed to run preloadbin for %s", package);
+        return;
     }
 
     log_preload(LOG_INFO, "Game %s preloaded success: total %d pages touched (~%s)", package,
-                total_pages, total_size);
-
-    pclose(fp);
+                progress.total_pages, progress.total_size);
 }
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#define GAMELIST_CACHE_MAGIC 0x4C475A41u /* "AZGL" */
+#define GAMELIST_CACHE_VERSION 1
+
+/**
+ * @struct GameListCacheHeader
+ * @brief Header of the compiled gamelist, followed by the GameConfig records and the index slots.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_mtime_ns;
+    uint64_t source_size;
+    uint64_t source_hash;
+    uint32_t record_size;
+    uint32_t count;
+    uint32_t index_mask;
+    uint32_t records_offset;
+    uint32_t index_offset;
+    uint32_t reserved[3];
+} GameListCacheHeader;
+
+_Static_assert(sizeof(GameListCacheHeader) == 64, "GameListCacheHeader layout changed");
+
+/**
+ * @brief Returns the modification time of a file in nanoseconds.
+ */
+static uint64_t mtime_ns(const struct stat* st) {
+    return (uint64_t)st->st_mtim.tv_sec * 1000000000ULL + (uint64_t)st->st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Hashes the gamelist source to detect content changes.
+ * @note FNV-1a mixing applied to 64-bit words instead of bytes, only used as a change key.
+ */
+static uint64_t hash_source(const char* data, size_t len) {
+    uint64_t h = 14695981039346656037ULL ^ len;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+        h ^= w;
+        h *= 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    for (; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Checks that a GameConfig string field is NUL terminated within its array.
+ */
+#define FIELD_TERMINATED(game, field) (memchr((game)->field, '\0', sizeof((game)->field)) != NULL)
+
+/**
+ * @brief Validates the records and index slots of a mapped cache before they are trusted.
+ * @note The mapping is read-only, so a corrupt body cannot be repaired in place and is rejected.
+ * Slot values must point inside the records and leave an empty slot to end every probe, and every
+ * string must be terminated so lookups and copies stay within the record.
+ * @return true if the body is safe to use.
+ */
+static bool cache_body_valid(const GameConfig* games, uint32_t count, const uint32_t* index, uint64_t slots) {
+    uint64_t used = 0;
+    for (uint64_t s = 0; s < slots; s++) {
+        if (index[s] > count)
+            return false;
+        used += index[s] != 0;
+    }
+    if (used > count)
+        return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const GameConfig* game = &games[i];
+        if (!FIELD_TERMINATED(game, package) || !FIELD_TERMINATED(game, perf_lite_mode) ||
+            !FIELD_TERMINATED(game, dnd_on_gaming) || !FIELD_TERMINATED(game, app_priority) ||
+            !FIELD_TERMINATED(game, game_preload) || !FIELD_TERMINATED(game, refresh_rate) ||
+            !FIELD_TERMINATED(game, renderer))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Frees one gamelist generation, unmapping it if it came from the compiled cache.
+ * @param list Generation to free, may be NULL.
+ */
+void free_gamelist(GameList* list) {
+    if (!list)
+        return;
+
+    if (list->map) {
+        munmap(list->map, list->map_len);
+    } else {
+        free((void*)list->games);
+        free((void*)list->index);
+    }
+    free(list);
+}
+
+/**
+ * @brief Maps the compiled gamelist read-only if it was built from the given source.
+ * @param st Stat of the JSON source.
+ * @param source_hash Hash of the JSON source, or 0 to match on mtime and size only.
+ * @return A generation backed by the mapping, or NULL if the cache is missing, stale or corrupt.
+ */
+static GameList* map_cache(const struct stat* st, uint64_t source_hash) {
+    int fd = open(GAMELIST_CACHE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    struct stat cst;
+    if (fstat(fd, &cst) != 0 || cst.st_size < (off_t)sizeof(GameListCacheHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t map_len = cst.st_size;
+    void* map = mmap(NULL, map_len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    const GameListCacheHeader* hdr = map;
+    uint64_t slots = (uint64_t)hdr->index_mask + 1;
+    bool valid = hdr->magic == GAMELIST_CACHE_MAGIC && hdr->version == GAMELIST_CACHE_VERSION &&
+                 hdr->record_size == sizeof(GameConfig) && hdr->count > 0 && (slots & (slots - 1)) == 0 &&
+                 slots >= (uint64_t)hdr->count * 2 && hdr->records_offset >= sizeof(GameListCacheHeader) &&
+                 hdr->records_offset + (uint64_t)hdr->count * sizeof(GameConfig) <= hdr->index_offset &&
+                 hdr->index_offset % sizeof(uint32_t) == 0 && hdr->index_offset + slots * sizeof(uint32_t) <= map_len;
+
+    bool fresh = source_hash ? hdr->source_hash == source_hash && hdr->source_size == (uint64_t)st->st_size
+                             : hdr->source_mtime_ns == mtime_ns(st) && hdr->source_size == (uint64_t)st->st_size;
+
+    const GameConfig* games = (const GameConfig*)((const char*)map + hdr->records_offset);
+    const uint32_t* index = (const uint32_t*)((const char*)map + hdr->index_offset);
+    valid = valid && fresh && cache_body_valid(games, hdr->count, index, slots);
+
+    GameList* list = valid ? malloc(sizeof(GameList)) : NULL;
+    if (!list) {
+        munmap(map, map_len);
+        return NULL;
+    }
+
+    list->games = games;
+    list->count = hdr->count;
+    list->index = index;
+    list->index_mask = hdr->index_mask;
+    list->map = map;
+    list->map_len = map_len;
+    return list;
+}
+
+/**
+ * @brief Writes a generation as the compiled gamelist, atomically replacing the previous one.
+ * @param list Generation to write.
+ * @param st Stat of the JSON source it was built from.
+ * @param source_hash Hash of the JSON source.
+ */
+static void write_cache(const GameList* list, const struct stat* st, uint64_t source_hash) {
+    GameListCacheHeader hdr = {0};
+    hdr.magic = GAMELIST_CACHE_MAGIC;
+    hdr.version = GAMELIST_CACHE_VERSION;
+    hdr.source_mtime_ns = mtime_ns(st);
+    hdr.source_size = st->st_size;
+    hdr.source_hash = source_hash;
+    hdr.record_size = sizeof(GameConfig);
+    hdr.count = list->count;
+    hdr.index_mask = list->index_mask;
+    hdr.records_offset = sizeof(hdr);
+    hdr.index_offset = hdr.records_offset + list->count * sizeof(GameConfig);
+
+    struct iovec iov[3] = {
+        {&hdr, sizeof(hdr)},
+        {(void*)list->games, list->count * sizeof(GameConfig)},
+        {(void*)list->index, (list->index_mask + 1) * sizeof(uint32_t)},
+    };
+    size_t total = iov[0].iov_len + iov[1].iov_len + iov[2].iov_len;
+
+    char tmp[PATH_MAX];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", GAMELIST_CACHE);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        log_zenith(LOG_WARN, "Unable to write compiled gamelist: %s", strerror(errno));
+        return;
+    }
+
+    ssize_t written = writev(fd, iov, 3);
+    close(fd);
+
+    if (written != (ssize_t)total || rename(tmp, GAMELIST_CACHE) != 0) {
+        log_zenith(LOG_WARN, "Unable to write compiled gamelist");
+        unlink(tmp);
+    }
+}
+
+/**
+ * @brief Builds a heap generation by parsing the JSON source.
+ * @return The new generation, or NULL if the source is malformed or allocation failed.
+ */
+static GameList* parse_source(const char* buf, size_t size) {
+    GameConfig* games = NULL;
+    int count = parse_gamelist(buf, size, &games);
+    if (count < 0)
+        return NULL;
+
+    GameList* list = malloc(sizeof(GameList));
+    if (!list) {
+        log_zenith(LOG_FATAL, "OOM: Failed to allocate gamelist generation");
+        free(games);
+        return NULL;
+    }
+    list->games = games;
+    list->count = count;
+    list->index = build_gamelist_index(games, count, &list->index_mask);
+    list->map = NULL;
+    list->map_len = 0;
+    if (!list->index && count > 0) {
+        log_zenith(LOG_FATAL, "OOM: Failed to allocate gamelist index");
+        free_gamelist(list);
+        return NULL;
+    }
+    return list;
+}
+
+/**
+ * @brief Loads the gamelist, preferring the compiled cache over parsing the JSON.
+ * @note An unchanged source (same mtime and size) is mapped without reading it. A touched but
+ * identical source (same hash) is mapped after hashing it. Anything else is parsed and the
+ * compiled cache rewritten.
+ * @param fd Open descriptor of the JSON source.
+ * @param st Stat of the JSON source.
+ * @return The new generation, or NULL if the caller should keep the previous one.
+ */
+GameList* load_gamelist(int fd, const struct stat* st) {
+    GameList* list = map_cache(st, 0);
+    if (list) {
+        log_verbose(LOG_DEBUG, "Gamelist mapped from compiled cache (%d entries)", list->count);
+        return list;
+    }
+
+    size_t size = st->st_size;
+    char* buf = malloc(size);
+    if (!buf) {
+        log_zenith(LOG_FATAL, "OOM: Failed to allocate GAMELIST read buffer");
+        return NULL;
+    }
+
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = pread(fd, buf + got, size - got, got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        got += n;
+    }
+    if (got != size) {
+        free(buf);
+        log_zenith(LOG_ERROR, "Failed to read data from GAMELIST file");
+        return NULL;
+    }
+
+    uint64_t hash = hash_source(buf, size);
+    list = map_cache(st, hash);
+    if (list) {
+        free(buf);
+        log_verbose(LOG_DEBUG, "Gamelist content unchanged, reusing compiled cache (%d entries)", list->count);
+        /* Refresh the recorded mtime so the next load skips the hash */
+        write_cache(list, st, hash);
+        return list;
+    }
+
+    list = parse_source(buf, size);
+    free(buf);
+    if (list && list->count > 0)
+        write_cache(list, st, hash);
+    return list;
+}
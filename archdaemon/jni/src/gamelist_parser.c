@@ -0,0 +1,529 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <stddef.h>
+
+#define GAMELIST_MAX_DEPTH 32
+#define GAMELIST_BENCH_ENTRIES 10000
+#define GAMELIST_BENCH_RUNS 5
+
+/**
+ * @struct JsonCursor
+ * @brief Read position inside the gamelist JSON buffer.
+ */
+typedef struct {
+    const char* p;
+    const char* end;
+} JsonCursor;
+
+/**
+ * @struct GameField
+ * @brief Maps a per-game JSON key to its GameConfig member.
+ */
+typedef struct {
+    const char* key;
+    size_t offset;
+    size_t size;
+} GameField;
+
+static const GameField game_fields[] = {
+    {"perf_lite_mode", offsetof(GameConfig, perf_lite_mode), sizeof(((GameConfig*)0)->perf_lite_mode)},
+    {"dnd_on_gaming", offsetof(GameConfig, dnd_on_gaming), sizeof(((GameConfig*)0)->dnd_on_gaming)},
+    {"app_priority", offsetof(GameConfig, app_priority), sizeof(((GameConfig*)0)->app_priority)},
+    {"game_preload", offsetof(GameConfig, game_preload), sizeof(((GameConfig*)0)->game_preload)},
+    {"refresh_rate", offsetof(GameConfig, refresh_rate), sizeof(((GameConfig*)0)->refresh_rate)},
+    {"renderer", offsetof(GameConfig, renderer), sizeof(((GameConfig*)0)->renderer)},
+};
+
+#define GAME_FIELD_COUNT (sizeof(game_fields) / sizeof(game_fields[0]))
+
+/**
+ * @brief Advances the cursor past JSON whitespace.
+ */
+static void skip_ws(JsonCursor* c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r'))
+        c->p++;
+}
+
+/**
+ * @brief Consumes one expected structural character.
+ * @return true if the next token was ch.
+ */
+static bool expect(JsonCursor* c, char ch) {
+    skip_ws(c);
+    if (c->p >= c->end || *c->p != ch)
+        return false;
+    c->p++;
+    return true;
+}
+
+/**
+ * @brief Parses four hex digits of a \u escape.
+ * @return The code unit, or -1 if malformed.
+ */
+static long parse_hex4(JsonCursor* c) {
+    if (c->end - c->p < 4)
+        return -1;
+
+    long v = 0;
+    for (int i = 0; i < 4; i++) {
+        char h = *c->p++;
+        v <<= 4;
+        if (h >= '0' && h <= '9')
+            v |= h - '0';
+        else if (h >= 'a' && h <= 'f')
+            v |= h - 'a' + 10;
+        else if (h >= 'A' && h <= 'F')
+            v |= h - 'A' + 10;
+        else
+            return -1;
+    }
+    return v;
+}
+
+/**
+ * @brief Parses a JSON string token, decoding escapes into dest.
+ * @note The cursor must sit on the opening quote. Values longer than dest are truncated.
+ * @param c Cursor.
+ * @param dest Destination buffer, or NULL to only skip the string.
+ * @param size Size of dest.
+ * @return true on success, false on malformed input.
+ */
+static bool parse_string(JsonCursor* c, char* dest, size_t size) {
+    size_t len = 0;
+
+    if (c->p >= c->end || *c->p != '"')
+        return false;
+    c->p++;
+
+    while (c->p < c->end) {
+        /* Copy the plain run up to the next quote or escape in one go, memchr is vectorized */
+        const char* run = c->p;
+        const char* quote = memchr(run, '"', c->end - run);
+        const char* escape = memchr(run, '\\', (quote ? quote : c->end) - run);
+        c->p = escape ? escape : (quote ? quote : c->end);
+        if (dest && len + 1 < size) {
+            size_t n = c->p - run;
+            if (n > size - 1 - len)
+                n = size - 1 - len;
+            memcpy(dest + len, run, n);
+            len += n;
+        }
+
+        if (c->p >= c->end)
+            return false;
+        if (*c->p == '"') {
+            c->p++;
+            if (dest && size > 0)
+                dest[len] = '\0';
+            return true;
+        }
+
+        c->p++;
+        if (c->p >= c->end)
+            return false;
+
+        char out[4];
+        size_t out_len = 1;
+        switch (*c->p++) {
+        case '"':
+            out[0] = '"';
+            break;
+        case '\\':
+            out[0] = '\\';
+            break;
+        case '/':
+            out[0] = '/';
+            break;
+        case 'b':
+            out[0] = '\b';
+            break;
+        case 'f':
+            out[0] = '\f';
+            break;
+        case 'n':
+            out[0] = '\n';
+            break;
+        case 'r':
+            out[0] = '\r';
+            break;
+        case 't':
+            out[0] = '\t';
+            break;
+        case 'u': {
+            long cp = parse_hex4(c);
+            if (cp < 0)
+                return false;
+            if (cp >= 0xD800 && cp <= 0xDBFF && c->end - c->p >= 6 && c->p[0] == '\\' && c->p[1] == 'u') {
+                c->p += 2;
+                long lo = parse_hex4(c);
+                if (lo < 0xDC00 || lo > 0xDFFF)
+                    return false;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            }
+
+            if (cp < 0x80) {
+                out[0] = (char)cp;
+            } else if (cp < 0x800) {
+                out[0] = (char)(0xC0 | (cp >> 6));
+                out[1] = (char)(0x80 | (cp & 0x3F));
+                out_len = 2;
+            } else if (cp < 0x10000) {
+                out[0] = (char)(0xE0 | (cp >> 12));
+                out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                out[2] = (char)(0x80 | (cp & 0x3F));
+                out_len = 3;
+            } else {
+                out[0] = (char)(0xF0 | (cp >> 18));
+                out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                out[3] = (char)(0x80 | (cp & 0x3F));
+                out_len = 4;
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+
+        if (dest && len + out_len < size) {
+            memcpy(dest + len, out, out_len);
+            len += out_len;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parses a bare literal (number, true, false, null).
+ * @param c Cursor.
+ * @param dest Destination for the literal text, or NULL to skip it.
+ * @param size Size of dest.
+ * @return true if a literal was consumed.
+ */
+static bool parse_literal(JsonCursor* c, char* dest, size_t size) {
+    const char* start = c->p;
+    while (c->p < c->end && *c->p != ',' && *c->p != '}' && *c->p != ']' && *c->p != ' ' && *c->p != '\t' &&
+           *c->p != '\n' && *c->p != '\r')
+        c->p++;
+
+    size_t n = c->p - start;
+    if (n == 0)
+        return false;
+
+    if (dest && size > 0) {
+        if (n >= size)
+            n = size - 1;
+        memcpy(dest, start, n);
+        dest[n] = '\0';
+    }
+    return true;
+}
+
+/**
+ * @brief Skips any JSON value, including nested objects and arrays.
+ * @note Nested containers are skipped with a depth counter instead of recursion.
+ * @return true on success, false on malformed input.
+ */
+static bool skip_value(JsonCursor* c) {
+    skip_ws(c);
+    if (c->p >= c->end)
+        return false;
+
+    if (*c->p == '"')
+        return parse_string(c, NULL, 0);
+    if (*c->p != '{' && *c->p != '[')
+        return parse_literal(c, NULL, 0);
+
+    int depth = 0;
+    while (c->p < c->end) {
+        char ch = *c->p;
+        if (ch == '"') {
+            if (!parse_string(c, NULL, 0))
+                return false;
+            continue;
+        }
+
+        c->p++;
+        if (ch == '{' || ch == '[') {
+            if (++depth > GAMELIST_MAX_DEPTH)
+                return false;
+        } else if (ch == '}' || ch == ']') {
+            if (--depth == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Fills one GameConfig from the per-game object at the cursor.
+ * @note Missing keys keep "default", unknown keys are skipped whatever their type.
+ * @return true on success, false on malformed input.
+ */
+static bool parse_game_object(JsonCursor* c, GameConfig* game) {
+    for (size_t i = 0; i < GAME_FIELD_COUNT; i++)
+        strcpy((char*)game + game_fields[i].offset, "default");
+
+    if (!expect(c, '{'))
+        return false;
+    if (expect(c, '}'))
+        return true;
+
+    do {
+        char key[32];
+        skip_ws(c);
+        if (!parse_string(c, key, sizeof(key)) || !expect(c, ':'))
+            return false;
+
+        const GameField* field = NULL;
+        for (size_t i = 0; i < GAME_FIELD_COUNT; i++) {
+            if (strcmp(key, game_fields[i].key) == 0) {
+                field = &game_fields[i];
+                break;
+            }
+        }
+
+        skip_ws(c);
+        if (!field) {
+            if (!skip_value(c))
+                return false;
+        } else if (c->p < c->end && *c->p == '"') {
+            if (!parse_string(c, (char*)game + field->offset, field->size))
+                return false;
+        } else if (c->p < c->end && *c->p != '{' && *c->p != '[') {
+            if (!parse_literal(c, (char*)game + field->offset, field->size))
+                return false;
+        } else if (!skip_value(c)) {
+            return false;
+        }
+    } while (expect(c, ','));
+
+    return expect(c, '}');
+}
+
+/**
+ * @brief Parses the gamelist JSON in a single pass.
+ * @note Top-level members that are not objects are ignored.
+ * @param json The JSON text.
+ * @param len Length of the JSON text.
+ * @param out Receives a malloc'd GameConfig array, NULL when no entry was found.
+ * @return Number of entries, or -1 if the document is malformed or allocation failed.
+ */
+int parse_gamelist(const char* json, size_t len, GameConfig** out) {
+    JsonCursor c = {json, json + len};
+    GameConfig* games = NULL;
+    int count = 0;
+    int capacity = 0;
+
+    *out = NULL;
+
+    /* Skip a UTF-8 BOM if the manager or a text editor left one */
+    if (len >= 3 && memcmp(json, "\xEF\xBB\xBF", 3) == 0)
+        c.p += 3;
+
+    if (!expect(&c, '{')) {
+        log_zenith(LOG_WARN, "GAMELIST is not a JSON object");
+        return -1;
+    }
+
+    if (!expect(&c, '}')) {
+        do {
+            if (count >= capacity) {
+                int new_capacity = capacity ? capacity * 2 : 16;
+                GameConfig* temp = realloc(games, new_capacity * sizeof(GameConfig));
+                if (!temp) {
+                    log_zenith(LOG_FATAL, "OOM: Realloc failed while parsing gamelist");
+                    free(games);
+                    return -1;
+                }
+                games = temp;
+                capacity = new_capacity;
+            }
+
+            GameConfig* game = &games[count];
+            skip_ws(&c);
+            if (!parse_string(&c, game->package, sizeof(game->package)) || !expect(&c, ':'))
+                goto malformed;
+
+            skip_ws(&c);
+            if (c.p < c.end && *c.p == '{') {
+                if (!parse_game_object(&c, game))
+                    goto malformed;
+                if (game->package[0])
+                    count++;
+            } else if (!skip_value(&c)) {
+                goto malformed;
+            }
+        } while (expect(&c, ','));
+
+        if (!expect(&c, '}'))
+            goto malformed;
+    }
+
+    *out = games;
+    return count;
+
+malformed:
+    /* Most likely caught mid-save, the next close-write event brings the complete file */
+    log_zenith(LOG_WARN, "GAMELIST is malformed near offset %ld, ignoring this version", (long)(c.p - json));
+    free(games);
+    return -1;
+}
+
+/**
+ * @brief Builds an open-addressing index over the package names of a parsed gamelist.
+ * @note Slots hold entry index + 1 (0 marks an empty slot) at a load factor <= 0.5. When a package
+ * is listed twice the first entry wins, like the old linear search.
+ * @param games Parsed gamelist entries.
+ * @param count Number of entries.
+ * @param mask Receives the slot mask (slot count - 1).
+ * @return malloc'd slot array, or NULL if count is 0 or allocation failed.
+ */
+uint32_t* build_gamelist_index(const GameConfig* games, int count, uint32_t* mask) {
+    *mask = 0;
+    if (count <= 0)
+        return NULL;
+
+    uint32_t slots = 16;
+    while (slots < (uint32_t)count * 2)
+        slots <<= 1;
+
+    uint32_t* index = calloc(slots, sizeof(uint32_t));
+    if (!index)
+        return NULL;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t s = fnv1a_hash(games[i].package) & (slots - 1);
+        while (index[s] && strcmp(games[index[s] - 1].package, games[i].package) != 0)
+            s = (s + 1) & (slots - 1);
+        if (!index[s])
+            index[s] = i + 1;
+    }
+
+    *mask = slots - 1;
+    return index;
+}
+
+/**
+ * @brief Looks up a package in a gamelist index.
+ * @param games Gamelist entries the index was built over.
+ * @param index Slot array from build_gamelist_index().
+ * @param mask Slot mask from build_gamelist_index().
+ * @param package Package name to look up.
+ * @return Entry index into games, or -1 if the package is not listed.
+ */
+int find_game_index(const GameConfig* games, const uint32_t* index, uint32_t mask, const char* package) {
+    if (!index || !package)
+        return -1;
+
+    uint32_t s = fnv1a_hash(package) & mask;
+    while (index[s]) {
+        if (strcmp(games[index[s] - 1].package, package) == 0)
+            return index[s] - 1;
+        s = (s + 1) & mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Benchmarks parse_gamelist() on a synthetic list and prints the timings.
+ * @param argc Number of CLI arguments.
+ * @param argv Array of CLI argument strings, argv[2] optionally holds the entry count.
+ * @return 0 on success, 1 on failure.
+ */
+int handle_bench_gamelist(int argc, char** argv) {
+    int entries = argc > 2 ? atoi(argv[2]) : GAMELIST_BENCH_ENTRIES;
+    if (entries <= 0) {
+        fprintf(stderr, "\033[31mERROR:\033[0m Invalid entry count\n");
+        return 1;
+    }
+
+    size_t cap = (size_t)entries * 320 + 16;
+    char* json = malloc(cap);
+    if (!json) {
+        fprintf(stderr, "\033[31mERROR:\033[0m Out of memory\n");
+        return 1;
+    }
+
+    /* Mix in escapes, unknown keys and non-string values so every parser path is exercised */
+    size_t len = snprintf(json, cap, "{\n");
+    for (int i = 0; i < entries; i++) {
+        len += snprintf(json + len, cap - len,
+                        "  \"com.bench.game%d\": {\n"
+                        "    \"perf_lite_mode\": \"%s\",\n"
+                        "    \"dnd_on_gaming\": \"default\",\n"
+                        "    \"app_priority\": \"true\",\n"
+                        "    \"game_preload\": \"default\",\n"
+                        "    \"refresh_rate\": \"%d\",\n"
+                        "    \"label\": \"Game \\\"%d\\\" \\u00e9\",\n"
+                        "    \"renderer\": \"default\"\n"
+                        "  }%s\n",
+                        i, (i & 1) ? "true" : "default", (i % 3) ? 120 : 90, i, i + 1 < entries ? "," : "");
+    }
+    len += snprintf(json + len, cap - len, "}\n");
+
+    double best = 0, total = 0;
+    int count = 0;
+    for (int run = 0; run < GAMELIST_BENCH_RUNS; run++) {
+        struct timespec start, end;
+        GameConfig* games = NULL;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        count = parse_gamelist(json, len, &games);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        free(games);
+
+        double ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+        total += ms;
+        if (run == 0 || ms < best)
+            best = ms;
+    }
+
+    printf("Gamelist parse: %d/%d entries, %.1f KiB, best %.3f ms, avg %.3f ms over %d runs\n", count, entries,
+           len / 1024.0, best, total / GAMELIST_BENCH_RUNS, GAMELIST_BENCH_RUNS);
+
+    GameConfig* games = NULL;
+    count = parse_gamelist(json, len, &games);
+    free(json);
+
+    struct timespec start, end;
+    uint32_t mask = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t* index = build_gamelist_index(games, count, &mask);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double build_ms = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+
+    /* Half hits, half misses, like focus changes between games and other apps */
+    int found = 0;
+    char package[MAX_PACKAGE];
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < entries * 2; i++) {
+        snprintf(package, sizeof(package), (i & 1) ? "com.other.app%d" : "com.bench.game%d", i / 2);
+        if (find_game_index(games, index, mask, package) >= 0)
+            found++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double lookup_ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / (entries * 2.0);
+
+    printf("Gamelist index: built in %.3f ms, %d/%d hits, %.0f ns per lookup\n", build_ms, found, entries * 2,
+           lookup_ns);
+
+    free(index);
+    free(games);
+    return count == entries && found == entries ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <signal.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define LOG_INGEST_SOCKET_NAME "azenith.log"
+#define LOG_INGEST_RCVBUF (256 * 1024)
+
+/*
+ * Datagram format sent by the Rust helpers, one line per datagram:
+ *     <L|V><level>|<tag>|<message>
+ * L goes to the main log, V to the verbose log.
+ */
+
+static int ingest_fd = -1;
+
+/**
+ * @brief Parses one helper datagram and hands it to the external logger.
+ * @param buf NUL-terminated datagram.
+ */
+static void ingest_line(char* buf) {
+    char kind = buf[0];
+    if ((kind != 'L' && kind != 'V') || buf[1] < '0' || buf[1] > '4' || buf[2] != '|')
+        return;
+
+    char* tag = buf + 3;
+    char* message = strchr(tag, '|');
+    if (!message)
+        return;
+    *message++ = '\0';
+
+    size_t len = strlen(message);
+    if (len > 0 && message[len - 1] == '\n')
+        message[len - 1] = '\0';
+
+    if (kind == 'L')
+        external_log(buf[1] - '0', tag, message);
+    else
+        external_vlog(buf[1] - '0', tag, message);
+}
+
+/**
+ * @brief Ingestion thread: receives helper log datagrams and queues them on the log writer.
+ * @note Datagrams from non-root senders are dropped.
+ */
+static void* log_ingest_worker(void* arg) {
+    (void)arg;
+    pthread_setname_np(pthread_self(), "AZenithLogIn");
+
+    char buf[MAX_DATA_LENGTH + 1];
+    union {
+        struct cmsghdr hdr;
+        char space[CMSG_SPACE(sizeof(struct ucred))];
+    } control;
+
+    for (;;) {
+        struct iovec iov = {.iov_base = buf, .iov_len = sizeof(buf) - 1};
+        struct msghdr msg = {.msg_iov = &iov, .msg_iovlen = 1, .msg_control = &control,
+                             .msg_controllen = sizeof(control)};
+
+        ssize_t n = recvmsg(ingest_fd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            log_zenith(LOG_ERROR, "Log ingestion socket failed: %s", strerror(errno));
+            return NULL;
+        }
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_CREDENTIALS)
+            continue;
+        struct ucred cred;
+        memcpy(&cred, CMSG_DATA(cmsg), sizeof(cred));
+        if (cred.uid != 0)
+            continue;
+
+        buf[n] = '\0';
+        ingest_line(buf);
+    }
+}
+
+/**
+ * @brief Opens the datagram socket the Rust helpers log to and starts draining it.
+ * @note Runs on its own thread rather than the main loop: helpers log while the main loop waits
+ * for them to finish, and a full datagram queue would block the sender.
+ */
+void log_ingest_start(void) {
+    ingest_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (ingest_fd < 0)
+        return;
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    memcpy(addr.sun_path + 1, LOG_INGEST_SOCKET_NAME, sizeof(LOG_INGEST_SOCKET_NAME) - 1);
+    socklen_t len = offsetof(struct sockaddr_un, sun_path) + 1 + sizeof(LOG_INGEST_SOCKET_NAME) - 1;
+
+    int one = 1;
+    int rcvbuf = LOG_INGEST_RCVBUF;
+    setsockopt(ingest_fd, SOL_SOCKET, SO_PASSCRED, &one, sizeof(one));
+    setsockopt(ingest_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    if (bind(ingest_fd, (struct sockaddr*)&addr, len) != 0) {
+        log_zenith(LOG_WARN, "Log ingestion socket unavailable (%s), helpers log through the CLI", strerror(errno));
+        close(ingest_fd);
+        ingest_fd = -1;
+        return;
+    }
+
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGTERM);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&thread, &attr, log_ingest_worker, NULL);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (ret != 0) {
+        log_zenith(LOG_WARN, "Failed to spawn log ingestion thread");
+        close(ingest_fd);
+        ingest_fd = -1;
+    }
+}
@@ -18,8 +18,11 @@
 #include <libgen.h>
 #include <poll.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <sys/inotify.h>
 
+#define MAX_TRACK_PIDS 2
+
 /**
  * @brief GLOBAL VARIABLES
  */
@@ -32,9 +35,6 @@ GameConfig opts;
 SystemStateCache current_system_cache;
 int java_lock_pipe[2];
 bool java_daemon_died = false;
-GameConfig* g_game_cache = NULL;
-int g_game_cache_count = 0;
-pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  * @struct PreloadArgs
@@ -44,6 +44,19 @@ typedef struct {
     char package[256];
 } PreloadArgs;
 
+/**
+ * @struct TransitionStat
+ * @brief How often one state transition happened and how long it took.
+ * @note Latency runs from the event to the new state being in place, dwell is the time spent in the
+ * previous state before the event arrived.
+ */
+typedef struct {
+    uint32_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t dwell_ns;
+} TransitionStat;
+
 /**
  * @struct DaemonContext
  * @brief Manages the internal state and lifecycle variables of the main daemon.
@@ -51,26 +64,85 @@ typedef struct {
 typedef struct {
     bool is_initialize_complete;
     bool dnd_enabled;
-    bool need_profile_checkup;
     bool bypass_applied;
     bool has_applied_renderer;
-    bool grace_period_active;
     int prev_screen_state;
     int saved_refresh_rate;
     int saved_zen_mode;
-    int pid_retries;
-    time_t screen_off_timer;
+    Timer grace_timer;
+    Timer preload_timer;
+    Timer renderer_timer;
+    Timer respawn_timer;
+    Timer gamelist_timer;
+    RetryTimer spawn_retry;
+    RetryTimer profile_retry;
+    char preload_package[256];
+    char renderer_package[256];
     ProfileMode cur_mode;
+    DaemonState state;
+    uint32_t pending_events;
+    uint64_t state_since_ns;
+    uint64_t launch_started_ns;
+    TransitionStat transitions[STATE_COUNT][STATE_COUNT];
+    TransitionStat launches;
+    uint32_t prop_mark;
+    uint32_t prop_transitions;
+    uint64_t prop_spawns_saved;
     char saved_renderer[PROP_VALUE_MAX];
     char last_freqoffset[PROP_VALUE_MAX];
+    bool freqoffset_synced;
+    ProfileMode freqoffset_mode;
+    int freqoffset_screen;
+    uint32_t freqoffset_applies;
+    uint32_t freqoffset_skipped;
     char prev_ai_state[16];
     const char* java_lock_path;
     char config_freqoffset[PROP_VALUE_MAX];
     char config_bypasspath[PROP_VALUE_MAX];
     int config_bypasschg;
     int config_bypasschgthreshold;
+    int app_state_fd;
+    int proc_events_fd;
+    bool proc_events_active;
+    int prop_change_fd;
+    int control_fd;
+    int timer_fd;
+    int game_pidfd[MAX_GAME_PIDS];
+    pid_t game_pidfd_pid[MAX_GAME_PIDS];
 } DaemonContext;
 
+/**
+ * @brief Directories watched through inotify.
+ */
+typedef enum : char {
+    WATCH_DIR_CONFIG,
+    WATCH_DIR_API,
+    WATCH_DIR_GAMELIST,
+    WATCH_DIR_BYPASS,
+    WATCH_DIR_MODULE,
+    WATCH_DIR_COUNT
+} WatchDir;
+
+/**
+ * @brief Files the daemon reacts to, each is handled at most once per wakeup.
+ */
+typedef enum : char {
+    WATCH_APP_STATUS,
+    WATCH_BACKGROUND_APPS,
+    WATCH_FREQOFFSET,
+    WATCH_CURRENT_PROFILE,
+    WATCH_CURRENT_MODES,
+    WATCH_GAMELIST,
+    WATCH_BYPASSPATH,
+    WATCH_BYPASSCHG,
+    WATCH_BYPASSCHG_THRESHOLD,
+    WATCH_MODULE_PROP,
+    WATCH_REBOOT,
+    WATCH_UPDATE,
+    WATCH_REMOVE,
+    WATCH_FILE_COUNT
+} WatchedFile;
+
 /**
  * @brief PRIVATE FUNCTION PROTOTYPES
  */
@@ -81,13 +153,44 @@ static void verify_system_integrity(void);
 static void wait_for_java_companion(DaemonContext* ctx);
 static void load_initial_config_files(DaemonContext* ctx);
 static int setup_inotify_watchers(void);
-static bool process_inotify_events(int inotify_fd, DaemonContext* ctx, int timeout_ms);
+static int match_watched_file(const struct inotify_event* event);
+static bool handle_watched_file(DaemonContext* ctx, WatchedFile file);
+static bool process_inotify_events(int inotify_fd, DaemonContext* ctx, int timeout_ms, bool* woke);
+static void update_game_pids(const pid_t* new_pids, int new_count);
 static void handle_background_apps_event(void);
+static int current_game_uid(void);
+static void handle_config_change(DaemonContext* ctx);
+static void sync_game_pidfds(DaemonContext* ctx);
+static void close_game_pidfds(DaemonContext* ctx);
 static void handle_dynamic_bypass(DaemonContext* ctx);
 static void apply_performance_profile(DaemonContext* ctx);
 static void apply_eco_profile(DaemonContext* ctx);
 static void apply_balanced_profile(DaemonContext* ctx);
+static void check_profile_result(DaemonContext* ctx, int status);
+static void begin_prop_count(DaemonContext* ctx);
+static void end_prop_count(DaemonContext* ctx, const char* profile);
+static void retry_profile(void* arg);
+static void on_grace_expired(void* arg);
+static void on_preload_due(void* arg);
+static void on_renderer_switched(void* arg);
+static void on_app_respawned(void* arg);
+static void on_gamelist_settled(void* arg);
+static void on_spawn_retry(void* arg);
+static void post_event(DaemonContext* ctx, DaemonEvent event);
+static void post_game_pids_event(DaemonContext* ctx, bool had_game);
+static void dispatch_events(DaemonContext* ctx);
+static void sync_proc_events(DaemonContext* ctx);
+static DaemonState finish_boot(DaemonContext* ctx);
+static DaemonState evaluate_profile(DaemonContext* ctx);
+static DaemonState settle_idle(DaemonContext* ctx);
+static DaemonState continue_launch(DaemonContext* ctx);
+static DaemonState check_game_pids(DaemonContext* ctx);
+static DaemonState begin_grace(DaemonContext* ctx);
+static DaemonState end_grace(DaemonContext* ctx);
+static DaemonState toggle_auto_mode(DaemonContext* ctx);
+static void sync_freqoffset(DaemonContext* ctx, int screen_state);
 static void reload_gamelist_cache(DaemonContext* ctx);
+static void handle_control_requests(DaemonContext* ctx);
 
 /**
  * @brief Thread worker function to run GamePreload asynchronously.
@@ -101,6 +204,22 @@ static void* async_preload_worker(void* arg) {
     return NULL;
 }
 
+/* A game may take a while to show up after it was focused, look again with growing delays */
+static const RetryPolicy spawn_retry_policy = {
+    .delay_ms = SPAWN_RETRY_DELAY_MS,
+    .max_delay_ms = SPAWN_RETRY_MAX_DELAY_MS,
+    .backoff = 2,
+    .max_attempts = SPAWN_RETRIES,
+};
+
+/* A profile whose settings script hung and was killed is applied again at a fixed pace */
+static const RetryPolicy profile_retry_policy = {
+    .delay_ms = PROFILE_RETRY_DELAY_MS,
+    .max_delay_ms = PROFILE_RETRY_DELAY_MS,
+    .backoff = 1,
+    .max_attempts = PROFILE_APPLY_RETRIES,
+};
+
 /**
  * @brief Initializes the daemon context with default values.
  * @param ctx Pointer to the DaemonContext structure.
@@ -109,32 +228,96 @@ static void init_daemon_context(DaemonContext* ctx) {
     memset(ctx, 0, sizeof(DaemonContext));
     ctx->is_initialize_complete = false;
     ctx->dnd_enabled = false;
-    ctx->need_profile_checkup = false;
     ctx->bypass_applied = false;
     ctx->has_applied_renderer = false;
-    ctx->grace_period_active = false;
     ctx->prev_screen_state = -1;
     ctx->saved_refresh_rate = -1;
     ctx->saved_zen_mode = -1;
-    ctx->pid_retries = 0;
-    ctx->screen_off_timer = 0;
+    timer_init(&ctx->grace_timer, on_grace_expired, ctx);
+    timer_init(&ctx->preload_timer, on_preload_due, ctx);
+    timer_init(&ctx->renderer_timer, on_renderer_switched, ctx);
+    timer_init(&ctx->respawn_timer, on_app_respawned, ctx);
+    timer_init(&ctx->gamelist_timer, on_gamelist_settled, ctx);
+    retry_init(&ctx->spawn_retry, &spawn_retry_policy, on_spawn_retry, ctx);
+    retry_init(&ctx->profile_retry, &profile_retry_policy, retry_profile, ctx);
     ctx->cur_mode = PERFCOMMON;
+    ctx->state = STATE_BOOT;
+    ctx->state_since_ns = exec_clock_ns();
     strcpy(ctx->last_freqoffset, "Initial");
     strcpy(ctx->prev_ai_state, "0");
     ctx->java_lock_path = "/data/adb/.config/AZenith/java.lock";
+    ctx->app_state_fd = -1;
+    ctx->proc_events_fd = -1;
+    ctx->prop_change_fd = -1;
+    ctx->control_fd = -1;
+    ctx->timer_fd = -1;
+    for (int i = 0; i < MAX_GAME_PIDS; i++)
+        ctx->game_pidfd[i] = -1;
+}
+
+/*
+ * The gamelist is published RCU style: reloads build a complete new generation off to the side and
+ * swap it in with one atomic exchange, so lookups never block on a parse or see a half-built list.
+ * The old generation is freed once every reader that could still hold it has released it.
+ */
+static _Atomic(GameList*) current_gamelist = NULL;
+static atomic_uint gamelist_epoch = 0;
+static atomic_int gamelist_readers[2] = {0, 0};
+
+/**
+ * @brief Pins the current gamelist generation for reading.
+ * @note Never blocks. Every call must be paired with gamelist_release() once the caller is done
+ * with the returned list.
+ * @param ticket Receives the reader slot to hand back to gamelist_release().
+ * @return The current generation, or NULL if no gamelist is loaded.
+ */
+const GameList* gamelist_acquire(unsigned int* ticket) {
+    *ticket = atomic_load(&gamelist_epoch) & 1;
+    atomic_fetch_add(&gamelist_readers[*ticket], 1);
+    return atomic_load(&current_gamelist);
 }
 
 /**
- * @brief Safely frees the gamelist cache memory under mutex lock.
+ * @brief Releases a generation pinned by gamelist_acquire().
+ * @param ticket Reader slot returned by gamelist_acquire().
  */
-void free_gamelist_cache(void) {
-    pthread_mutex_lock(&cache_mutex);
-    if (g_game_cache != NULL) {
-        free(g_game_cache);
-        g_game_cache = NULL;
+void gamelist_release(unsigned int ticket) {
+    atomic_fetch_sub(&gamelist_readers[ticket], 1);
+}
+
+/**
+ * @brief Waits until every reader that could still see a retired generation has released it.
+ * @note Readers are split over two epoch slots. Flipping the epoch sends new readers to the other
+ * slot, so each wait only covers readers that started before it and a steady stream of lookups
+ * cannot starve the reload.
+ */
+static void wait_for_gamelist_readers(void) {
+    for (int phase = 0; phase < 2; phase++) {
+        unsigned int old = atomic_fetch_add(&gamelist_epoch, 1) & 1;
+        while (atomic_load(&gamelist_readers[old]) > 0)
+            usleep(50);
     }
-    g_game_cache_count = 0;
-    pthread_mutex_unlock(&cache_mutex);
+}
+
+/**
+ * @brief Publishes a new gamelist generation and reclaims the previous one.
+ * @note Only the reloading thread calls this, so there is never more than one retired generation.
+ * @param list New generation, or NULL to unload the gamelist.
+ */
+static void publish_gamelist(GameList* list) {
+    GameList* old = atomic_exchange(&current_gamelist, list);
+    if (!old)
+        return;
+
+    wait_for_gamelist_readers();
+    free_gamelist(old);
+}
+
+/**
+ * @brief Unloads the gamelist cache once no reader uses it anymore.
+ */
+void free_gamelist_cache(void) {
+    publish_gamelist(NULL);
 }
 
 /**
@@ -160,6 +343,7 @@ static void load_initial_config_files(DaemonContext* ctx) {
         }
         fclose(fp);
     }
+    select_bypass_node(ctx->config_bypasspath);
 
     if ((fp = fopen("/data/adb/.config/AZenith/bypasschgconfig/bypasschg", "r"))) {
         if (fgets(val, sizeof(val), fp))
@@ -182,136 +366,42 @@ static void load_initial_config_files(DaemonContext* ctx) {
  * @param ctx Pointer to the DaemonContext structure.
  */
 void reload_gamelist_cache(DaemonContext* ctx) {
-    free_gamelist_cache();
-
-    FILE* fp = fopen(GAMELIST, "r");
-    if (!fp) {
+    int fd = open(GAMELIST, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
         log_zenith(LOG_ERROR, "Failed to open GAMELIST for caching.");
+        free_gamelist_cache();
         return;
     }
 
-    fseek(fp, 0, SEEK_END);
-    long size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    if (size <= 0) {
-        fclose(fp);
-        log_zenith(LOG_WARN, "GAMELIST is empty or invalid.");
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        log_zenith(LOG_WARN, "GAMELIST is empty or invalid, keeping the previous list.");
         return;
     }
 
-    char* buf = malloc(size + 1);
-    if (!buf) {
-        fclose(fp);
-        log_zenith(LOG_FATAL, "OOM: Failed to allocate GAMELIST read buffer");
-        return;
-    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
-    if (fread(buf, 1, size, fp) != (size_t)size) {
-        fclose(fp);
-        free(buf);
-        log_zenith(LOG_ERROR, "Failed to read data from GAMELIST file");
-        return;
-    }
-    fclose(fp);
-    buf[size] = '\0';
+    GameList* list = load_gamelist(fd, &st);
+    close(fd);
 
-    pthread_mutex_lock(&cache_mutex);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    log_verbose(LOG_DEBUG, "Gamelist loaded in %.3f ms (%lld bytes)",
+                (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6,
+                (long long)st.st_size);
 
-    int capacity = 16;
-    g_game_cache = malloc(capacity * sizeof(GameConfig));
-    if (!g_game_cache) {
-        free(buf);
-        pthread_mutex_unlock(&cache_mutex);
-        log_zenith(LOG_FATAL, "OOM: Failed to allocate game cache array");
+    /* Keep serving the previous generation when this version could not be parsed */
+    if (!list)
         return;
-    }
-
-    char* ptr = buf;
-    while ((ptr = strstr(ptr, "\": {")) != NULL) {
-        char* start_quote = ptr - 1;
-        while (start_quote > buf && *start_quote != '"') {
-            start_quote--;
-        }
 
-        if (*start_quote == '"') {
-            if (g_game_cache_count >= capacity) {
-                capacity *= 2;
-                GameConfig* temp = realloc(g_game_cache, capacity * sizeof(GameConfig));
-                if (!temp) {
-                    log_zenith(LOG_FATAL, "OOM: Realloc failed while parsing gamelist");
-                    free(g_game_cache);
-                    g_game_cache = NULL;
-                    g_game_cache_count = 0;
-                    break;
-                }
-                g_game_cache = temp;
-            }
-
-            size_t pkg_len = ptr - (start_quote + 1);
-            if (pkg_len >= sizeof(g_game_cache[g_game_cache_count].package)) {
-                pkg_len = sizeof(g_game_cache[g_game_cache_count].package) - 1;
-            }
-            strncpy(g_game_cache[g_game_cache_count].package, start_quote + 1, pkg_len);
-            g_game_cache[g_game_cache_count].package[pkg_len] = '\0';
-
-            char* next_block = strstr(ptr + 4, "\": {");
-            char* p;
-
-            p = strstr(ptr, "\"perf_lite_mode\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].perf_lite_mode, p,
-                                     sizeof(g_game_cache[g_game_cache_count].perf_lite_mode));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].perf_lite_mode, "default");
-
-            p = strstr(ptr, "\"dnd_on_gaming\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].dnd_on_gaming, p,
-                                     sizeof(g_game_cache[g_game_cache_count].dnd_on_gaming));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].dnd_on_gaming, "default");
-
-            p = strstr(ptr, "\"app_priority\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].app_priority, p,
-                                     sizeof(g_game_cache[g_game_cache_count].app_priority));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].app_priority, "default");
-
-            p = strstr(ptr, "\"game_preload\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].game_preload, p,
-                                     sizeof(g_game_cache[g_game_cache_count].game_preload));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].game_preload, "default");
-
-            p = strstr(ptr, "\"refresh_rate\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].refresh_rate, p,
-                                     sizeof(g_game_cache[g_game_cache_count].refresh_rate));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].refresh_rate, "default");
-
-            p = strstr(ptr, "\"renderer\":");
-            if (p && (!next_block || p < next_block)) {
-                extract_string_value(g_game_cache[g_game_cache_count].renderer, p,
-                                     sizeof(g_game_cache[g_game_cache_count].renderer));
-            } else
-                strcpy(g_game_cache[g_game_cache_count].renderer, "default");
-
-            g_game_cache_count++;
-        }
-        ptr += 4;
-    }
-
-    free(buf);
-    pthread_mutex_unlock(&cache_mutex);
+    int count = list->count;
+    publish_gamelist(list);
 
     if (!ctx->is_initialize_complete) {
         log_zenith(LOG_INFO,
                    "Gamelist in-memory cache loaded successfully. Total: %d games registered.",
-                   g_game_cache_count);
+                   count);
     }
 }
 
@@ -387,8 +477,8 @@ static void wait_for_java_companion(DaemonContext* ctx) {
             log_zenith(LOG_FATAL, "Java companion daemon absent after %d checks, exiting",
                        MAX_JAVA_RETRIES);
             notify("Daemon Error", "Java companion daemon crashed or failed to start.", false, 0);
-            systemv("setprop persist.sys.azenith.service \"\"");
-            systemv("setprop persist.sys.azenith.state stopped");
+            prop_set("persist.sys.azenith.service", "");
+            prop_set("persist.sys.azenith.state", "stopped");
             exit(EXIT_FAILURE);
         }
         if (java_check_retries <= 1) {
@@ -399,6 +489,56 @@ static void wait_for_java_companion(DaemonContext* ctx) {
     log_zenith(LOG_INFO, "Java companion daemon detected. Proceeding.");
 }
 
+/*
+ * Watched directories and the files in them the daemon reacts to. Events are routed by watch
+ * descriptor to the files of their directory, so a name is only compared against the few files that
+ * can live there, and every matching file is marked dirty instead of being handled on the spot.
+ */
+static const struct {
+    const char* path;
+    uint32_t mask;
+} watch_dirs[WATCH_DIR_COUNT] = {
+    [WATCH_DIR_CONFIG] = {"/data/adb/.config/AZenith/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
+    [WATCH_DIR_API] = {"/data/adb/.config/AZenith/API/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
+    [WATCH_DIR_GAMELIST] = {"/data/adb/.config/AZenith/gamelist/", IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE},
+    [WATCH_DIR_BYPASS] = {"/data/adb/.config/AZenith/bypasschgconfig/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
+    [WATCH_DIR_MODULE] = {"/data/adb/modules/AZenith/", IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_DELETE},
+};
+
+/* WatchedFile is ordered by directory, prefix entries also match temporary names like "<name>.tmp" */
+static const struct {
+    WatchDir dir;
+    const char* name;
+    uint8_t len;
+    bool prefix;
+    uint32_t mask;
+} watch_files[WATCH_FILE_COUNT] = {
+#define WATCH_FILE(d, f, n, p, m) [f] = {d, n, sizeof(n) - 1, p, m}
+    WATCH_FILE(WATCH_DIR_CONFIG, WATCH_APP_STATUS, "app_status", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_CONFIG, WATCH_BACKGROUND_APPS, "background_apps", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_CONFIG, WATCH_FREQOFFSET, "freqoffset", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_API, WATCH_CURRENT_PROFILE, "current_profile", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_API, WATCH_CURRENT_MODES, "current_modes", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_GAMELIST, WATCH_GAMELIST, "azenithApplist.json", true, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE),
+    WATCH_FILE(WATCH_DIR_BYPASS, WATCH_BYPASSPATH, "bypasspath", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_BYPASS, WATCH_BYPASSCHG, "bypasschg", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_BYPASS, WATCH_BYPASSCHG_THRESHOLD, "bypasschgthreshold", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_MODULE, WATCH_MODULE_PROP, "module.prop", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_MODULE, WATCH_REBOOT, "reboot", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_MODULE, WATCH_UPDATE, "update", false, IN_ALL_EVENTS),
+    WATCH_FILE(WATCH_DIR_MODULE, WATCH_REMOVE, "remove", false, IN_ALL_EVENTS),
+#undef WATCH_FILE
+};
+
+/* Files worth re-reading when the kernel queue overflowed and their events were lost */
+#define WATCH_RESYNC_MASK                                                                          \
+    ((1u << WATCH_APP_STATUS) | (1u << WATCH_BACKGROUND_APPS) | (1u << WATCH_FREQOFFSET) |         \
+     (1u << WATCH_CURRENT_PROFILE) | (1u << WATCH_CURRENT_MODES) | (1u << WATCH_GAMELIST) |        \
+     (1u << WATCH_BYPASSPATH) | (1u << WATCH_BYPASSCHG) | (1u << WATCH_BYPASSCHG_THRESHOLD))
+
+static int watch_wds[WATCH_DIR_COUNT] = {-1, -1, -1, -1, -1};
+static uint8_t watch_first[WATCH_DIR_COUNT + 1];
+
 /**
  * @brief Sets up inotify watchers for relevant module directories.
  * @return File descriptor for inotify, or -1 on failure.
@@ -408,44 +548,48 @@ static int setup_inotify_watchers(void) {
     if (fd < 0)
         return -1;
 
-    struct WatchTarget {
-        const char* path;
-        uint32_t mask;
-    } targets[] = {
-        {"/data/adb/.config/AZenith/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
-        {"/data/adb/.config/AZenith/API/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
-        {"/data/adb/.config/AZenith/gamelist/",
-         IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE},
-        {"/data/adb/.config/AZenith/bypasschgconfig/", IN_MODIFY | IN_CREATE | IN_MOVED_TO},
-        {"/data/adb/modules/AZenith/", IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_DELETE}};
-
-    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
-        inotify_add_watch(fd, targets[i].path, targets[i].mask);
+    for (int i = 0; i < WATCH_DIR_COUNT; i++)
+        watch_wds[i] = inotify_add_watch(fd, watch_dirs[i].path, watch_dirs[i].mask);
+
+    /* Remember where the files of each directory start in watch_files */
+    int file = 0;
+    for (int dir = 0; dir <= WATCH_DIR_COUNT; dir++) {
+        while (file < WATCH_FILE_COUNT && (int)watch_files[file].dir < dir)
+            file++;
+        watch_first[dir] = file;
     }
     return fd;
 }
 
 /**
- * @brief Processes PID adjustments when background_apps event is triggered.
+ * @brief Resolves an inotify event to the watched file it is about.
+ * @param event Event read from the inotify fd.
+ * @return The WatchedFile, or -1 if the daemon does not care about it.
  */
-static void handle_background_apps_event(void) {
-    if (!gamestart)
-        return;
-
-    pid_t new_pids[MAX_GAME_PIDS];
-    int max_track_pids = 2;
-    int new_count = get_pids_of(gamestart, new_pids, max_track_pids);
+static int match_watched_file(const struct inotify_event* event) {
+    int dir = 0;
+    while (dir < WATCH_DIR_COUNT && watch_wds[dir] != event->wd)
+        dir++;
+    if (dir == WATCH_DIR_COUNT || event->len == 0)
+        return -1;
 
-    if (new_count == 0 && game_pid_count > 0) {
-        struct stat st;
-        if (stat("/data/adb/.config/AZenith/background_apps", &st) == 0 && st.st_size == 0) {
-            new_count = game_pid_count;
-            for (int i = 0; i < game_pid_count; i++) {
-                new_pids[i] = game_pids[i];
-            }
-        }
+    size_t len = strlen(event->name);
+    for (int i = watch_first[dir]; i < watch_first[dir + 1]; i++) {
+        if (len < watch_files[i].len || (!watch_files[i].prefix && len != watch_files[i].len))
+            continue;
+        if (memcmp(event->name, watch_files[i].name, watch_files[i].len) == 0)
+            return (event->mask & watch_files[i].mask) ? i : -1;
     }
+    return -1;
+}
 
+/**
+ * @brief Replaces the tracked game PIDs, applying priorities to new ones and dropping the game once
+ * all of them are gone.
+ * @param new_pids The new PID list.
+ * @param new_count Number of PIDs in the new list.
+ */
+static void update_game_pids(const pid_t* new_pids, int new_count) {
     bool pids_changed = false;
     if (new_count != game_pid_count) {
         pids_changed = true;
@@ -483,7 +627,7 @@ static void handle_background_apps_event(void) {
                 set_priority(game_pids[i]);
             } else if (!IS_FALSE(opts.app_priority)) {
                 char val[PROP_VALUE_MAX] = {0};
-                if (__system_property_get("persist.sys.azenithconf.iosched", val) > 0 &&
+                if (prop_cache_get(PROP_IOSCHED, val) > 0 &&
                     val[0] == '1') {
                     set_priority(game_pids[i]);
                 }
@@ -510,23 +654,269 @@ static void handle_background_apps_event(void) {
 }
 
 /**
- * @brief Reads events from inotify descriptor and routes actions.
+ * @brief Processes PID adjustments when background_apps event is triggered.
+ */
+static void handle_background_apps_event(void) {
+    rebuild_process_table();
+
+    if (!gamestart)
+        return;
+
+    pid_t new_pids[MAX_GAME_PIDS];
+    int new_count = get_pids_of(gamestart, new_pids, MAX_TRACK_PIDS);
+
+    if (new_count == 0 && game_pid_count > 0) {
+        if (process_table_size() == 0) {
+            new_count = game_pid_count;
+            for (int i = 0; i < game_pid_count; i++) {
+                new_pids[i] = game_pids[i];
+            }
+        }
+    }
+
+    update_game_pids(new_pids, new_count);
+}
+
+/**
+ * @brief Resolves the app UID of the current game.
+ * @return The UID, or -1 if it is not known yet.
+ */
+static int current_game_uid(void) {
+    if (!gamestart)
+        return -1;
+
+    for (int i = 0; i < game_pid_count; i++) {
+        int uid = uidof(game_pids[i]);
+        if (uid >= 0)
+            return uid;
+    }
+
+    if (strcmp(current_system_cache.focused_app, gamestart) == 0 && current_system_cache.focused_uid > 0)
+        return current_system_cache.focused_uid;
+
+    return -1;
+}
+
+/**
+ * @brief Reacts to configuration properties that changed while the daemon runs.
+ * @note Every cached property is picked up at its next use, only settings that affect an already
+ * running game are applied here.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void handle_config_change(DaemonContext* ctx) {
+    uint32_t changes = prop_cache_take_changes(ctx->prop_change_fd);
+    char val[PROP_VALUE_MAX];
+
+    for (int i = 0; i < PROP_COUNT; i++) {
+        if (changes & (1u << i)) {
+            prop_cache_get((CachedProp)i, val);
+            log_zenith(LOG_INFO, "Config changed: %s=[%s]", prop_cache_name((CachedProp)i), val);
+        }
+    }
+
+    if ((changes & (1u << PROP_IOSCHED)) && gamestart && IS_DEFAULT(opts.app_priority) &&
+        prop_cache_get(PROP_IOSCHED, val) > 0 && val[0] == '1') {
+        for (int i = 0; i < game_pid_count; i++)
+            set_priority(game_pids[i]);
+    }
+}
+
+/**
+ * @brief Keeps one pidfd open per tracked game PID so process exit shows up in the poll set.
+ * @note Slot i always mirrors game_pids[i]; stale pidfds are closed and new PIDs opened.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void sync_game_pidfds(DaemonContext* ctx) {
+    for (int i = 0; i < MAX_GAME_PIDS; i++) {
+        pid_t want = i < game_pid_count ? game_pids[i] : 0;
+        if (ctx->game_pidfd[i] >= 0 && ctx->game_pidfd_pid[i] == want)
+            continue;
+
+        if (ctx->game_pidfd[i] >= 0)
+            close(ctx->game_pidfd[i]);
+        ctx->game_pidfd[i] = want > 0 ? pidfd_of(want) : -1;
+        ctx->game_pidfd_pid[i] = want;
+    }
+}
+
+/**
+ * @brief Closes every game pidfd.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void close_game_pidfds(DaemonContext* ctx) {
+    for (int i = 0; i < MAX_GAME_PIDS; i++) {
+        if (ctx->game_pidfd[i] >= 0)
+            close(ctx->game_pidfd[i]);
+        ctx->game_pidfd[i] = -1;
+    }
+}
+
+/**
+ * @brief Picks up the new content of a watched file.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param file File that changed since the last wakeup.
+ * @return true if the daemon has to exit, false otherwise.
+ */
+static bool handle_watched_file(DaemonContext* ctx, WatchedFile file) {
+    switch (file) {
+        case WATCH_APP_STATUS:
+            if (app_state_channel_active())
+                break;
+            /* The companion keeps writing app_status until we listen, it may have mapped the block since */
+            ctx->app_state_fd = app_state_channel_open();
+            read_app_status(&current_system_cache);
+            post_event(ctx, EVENT_APP_STATE);
+            break;
+        case WATCH_BACKGROUND_APPS: {
+            bool had_game = gamestart != NULL;
+            handle_background_apps_event();
+            post_game_pids_event(ctx, had_game);
+            break;
+        }
+        case WATCH_FREQOFFSET: {
+            FILE* fp = fopen("/data/adb/.config/AZenith/freqoffset", "r");
+            if (fp) {
+                if (fgets(ctx->config_freqoffset, sizeof(ctx->config_freqoffset), fp)) {
+                    trim_newline(ctx->config_freqoffset);
+                    log_zenith(LOG_INFO, "Inotify: freqoffset updated to [%s]", ctx->config_freqoffset);
+                }
+                fclose(fp);
+            }
+            break;
+        }
+        case WATCH_CURRENT_PROFILE: {
+            FILE* fp_prof = fopen(PROFILE_MODE, "r");
+            if (fp_prof) {
+                char prof_val[8] = {0};
+                if (fgets(prof_val, sizeof(prof_val), fp_prof)) {
+                    trim_newline(prof_val);
+                    int ext_profile = atoi(prof_val);
+                    ctx->cur_mode = (ProfileMode)ext_profile;
+                }
+                fclose(fp_prof);
+            }
+            break;
+        }
+        case WATCH_CURRENT_MODES: {
+            FILE* fp_ai = fopen(DAEMON_MODES, "r");
+            if (fp_ai) {
+                char ai_state[16] = "0";
+                if (fgets(ai_state, sizeof(ai_state), fp_ai)) {
+                    trim_newline(ai_state);
+
+                    if (ctx->is_initialize_complete && strcmp(ctx->prev_ai_state, ai_state) != 0) {
+                        strcpy(ctx->prev_ai_state, ai_state);
+                        post_event(ctx, EVENT_AUTO_MODE);
+                    }
+                }
+                fclose(fp_ai);
+            }
+            break;
+        }
+        case WATCH_GAMELIST:
+            /* Reload once the writer settled, a burst of events only pushes it back */
+            timer_schedule(&ctx->gamelist_timer, GAMELIST_SETTLE_MS);
+            break;
+        case WATCH_BYPASSPATH: {
+            FILE* fp = fopen("/data/adb/.config/AZenith/bypasschgconfig/bypasspath", "r");
+            if (fp) {
+                if (fgets(ctx->config_bypasspath, sizeof(ctx->config_bypasspath), fp)) {
+                    trim_newline(ctx->config_bypasspath);
+                }
+                fclose(fp);
+
+                if (ctx->bypass_applied) {
+                    disable_bypass();
+                    ctx->bypass_applied = false;
+                }
+                select_bypass_node(ctx->config_bypasspath);
+            }
+            break;
+        }
+        case WATCH_BYPASSCHG: {
+            char val[16] = {0};
+            FILE* fp = fopen("/data/adb/.config/AZenith/bypasschgconfig/bypasschg", "r");
+            if (fp) {
+                if (fgets(val, sizeof(val), fp))
+                    ctx->config_bypasschg = atoi(val);
+                fclose(fp);
+            }
+            break;
+        }
+        case WATCH_BYPASSCHG_THRESHOLD: {
+            char val[16] = {0};
+            FILE* fp = fopen("/data/adb/.config/AZenith/bypasschgconfig/bypasschgthreshold", "r");
+            if (fp) {
+                if (fgets(val, sizeof(val), fp))
+                    ctx->config_bypasschgthreshold = atoi(val);
+                fclose(fp);
+            }
+            break;
+        }
+        case WATCH_MODULE_PROP:
+            log_zenith(LOG_INFO, "module.prop modified...");
+            is_kanged();
+            check_module_version();
+            break;
+        case WATCH_REBOOT:
+            log_zenith(LOG_INFO, "Configuration updated, notify user to reboot");
+            notify("Daemon Info", "Configuration updated. Please reboot your device to take full effect.", false, 0);
+            break;
+        case WATCH_UPDATE:
+            log_zenith(LOG_INFO, "Module update detected, exiting.");
+            notify("Module Update", "Please reboot your device to complete module update.", false, 0);
+            prop_set("persist.sys.azenith.service", "");
+            prop_set("persist.sys.azenith.state", "stopped");
+            return true;
+        case WATCH_REMOVE:
+            log_zenith(LOG_INFO, "Module is removed, exiting.");
+            notify("Module Removed", "Please reboot your device to complete module uninstallation.", false, 0);
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
+
+/**
+ * @brief Waits for the next event and routes actions.
+ * @note Deferred work arrives through the timer wheel's timerfd, so callers never need a timeout
+ * other than 0 or -1.
  * @param inotify_fd Watcher file descriptor.
  * @param ctx Pointer to DaemonContext structure.
  * @param timeout_ms Poll timeout in milliseconds.
+ * @param woke Set to false when the wakeup only brought process events that changed nothing the
+ * daemon tracks, the proc connector reports every fork, exec and exit of the whole system.
  * @return true if an exit command was received, false otherwise.
  */
-static bool process_inotify_events(int inotify_fd, DaemonContext* ctx, int timeout_ms) {
+static bool process_inotify_events(int inotify_fd, DaemonContext* ctx, int timeout_ms, bool* woke) {
+    *woke = true;
     if (inotify_fd < 0)
         return false;
 
-    struct pollfd pfds[2];
+    sync_game_pidfds(ctx);
+
+    struct pollfd pfds[7 + MAX_GAME_PIDS];
     pfds[0].fd = inotify_fd;
     pfds[0].events = POLLIN;
     pfds[1].fd = java_lock_pipe[0];
     pfds[1].events = POLLIN;
+    pfds[2].fd = ctx->app_state_fd;
+    pfds[2].events = POLLIN;
+    pfds[3].fd = ctx->proc_events_active ? ctx->proc_events_fd : -1;
+    pfds[3].events = POLLIN;
+    pfds[4].fd = ctx->prop_change_fd;
+    pfds[4].events = POLLIN;
+    pfds[5].fd = ctx->control_fd;
+    pfds[5].events = POLLIN;
+    pfds[6].fd = ctx->timer_fd;
+    pfds[6].events = POLLIN;
+    for (int i = 0; i < MAX_GAME_PIDS; i++) {
+        pfds[7 + i].fd = ctx->game_pidfd[i];
+        pfds[7 + i].events = POLLIN;
+    }
 
-    int ret = poll(pfds, 2, timeout_ms);
+    int ret = poll(pfds, 7 + MAX_GAME_PIDS, timeout_ms);
 
     if (ret > 0) {
         if (pfds[1].revents & POLLIN) {
@@ -534,151 +924,94 @@ static bool process_inotify_events(int inotify_fd, DaemonContext* ctx, int timeo
             return true;
         }
 
+        if (pfds[2].revents & POLLIN) {
+            app_state_channel_drain(ctx->app_state_fd);
+            read_app_status(&current_system_cache);
+            post_event(ctx, EVENT_APP_STATE);
+        }
+
+        if (pfds[4].revents & POLLIN)
+            handle_config_change(ctx);
+
+        /* pidfds mirror game_pids slot by slot, a readable pidfd means that process is gone */
+        pid_t alive_pids[MAX_GAME_PIDS];
+        int alive_count = 0;
+        bool game_pid_exited = false;
+        for (int i = 0; i < game_pid_count; i++) {
+            if (pfds[7 + i].fd >= 0 && (pfds[7 + i].revents & (POLLIN | POLLHUP))) {
+                log_verbose(LOG_DEBUG, "Game process %d exited", game_pids[i]);
+                close(ctx->game_pidfd[i]);
+                ctx->game_pidfd[i] = -1;
+                game_pid_exited = true;
+            } else {
+                alive_pids[alive_count++] = game_pids[i];
+            }
+        }
+
+        if (game_pid_exited && gamestart) {
+            update_game_pids(alive_pids, alive_count);
+            post_game_pids_event(ctx, true);
+        }
+
+        if (pfds[3].revents & POLLIN) {
+            pid_t new_pids[MAX_GAME_PIDS];
+            memcpy(new_pids, game_pids, sizeof(new_pids));
+
+            int new_count = proc_events_handle(ctx->proc_events_fd, gamestart, current_game_uid(), new_pids,
+                                               game_pid_count, MAX_TRACK_PIDS);
+            if (new_count >= 0 && gamestart) {
+                update_game_pids(new_pids, new_count);
+                post_game_pids_event(ctx, true);
+            }
+        }
+
+        if (pfds[5].revents & POLLIN)
+            handle_control_requests(ctx);
+
         if (pfds[0].revents & POLLIN) {
             char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
             ssize_t len;
+            uint32_t dirty = 0;
+            int events = 0;
 
+            /* Drain the whole queue first, a burst of writes to one file is handled once */
             while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
                 for (char* ptr = buf; ptr < buf + len;) {
                     struct inotify_event* event = (struct inotify_event*)ptr;
-                    if (event->len > 0) {
-
-                        if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)) {
-                            if (strstr(event->name, "azenithApplist.json")) {
-                                usleep(50000);
-                                reload_gamelist_cache(ctx);
-                                ctx->need_profile_checkup = true;
-                            }
-                        }
-
-                        if (strcmp(event->name, "app_status") == 0) {
-                            read_app_status(&current_system_cache);
-                            ctx->need_profile_checkup = true;
-                        } else if (strcmp(event->name, "background_apps") == 0) {
-                            handle_background_apps_event();
-                            if (gamestart == NULL)
-                                ctx->need_profile_checkup = true;
-                        } else if (strcmp(event->name, "current_profile") == 0) {
-                            FILE* fp_prof = fopen(PROFILE_MODE, "r");
-                            if (fp_prof) {
-                                char prof_val[8] = {0};
-                                if (fgets(prof_val, sizeof(prof_val), fp_prof)) {
-                                    trim_newline(prof_val);
-                                    int ext_profile = atoi(prof_val);
-                                    ctx->cur_mode = (ProfileMode)ext_profile;
-                                }
-                                fclose(fp_prof);
-                            }
-                        } else if (strcmp(event->name, "current_modes") == 0) {
-                            FILE* fp_ai = fopen(DAEMON_MODES, "r");
-                            if (fp_ai) {
-                                char ai_state[16] = "0";
-                                if (fgets(ai_state, sizeof(ai_state), fp_ai)) {
-                                    trim_newline(ai_state);
-
-                                    if (ctx->is_initialize_complete &&
-                                        strcmp(ctx->prev_ai_state, ai_state) != 0) {
-                                        log_zenith(LOG_INFO, "Dynamic profile toggled, Reapplying "
-                                                             "Balanced Profiles");
-                                        ctx->cur_mode = PERFCOMMON;
-                                        apply_balanced_profile(ctx);
-                                        strcpy(ctx->prev_ai_state, ai_state);
-
-                                        if (strcmp(ai_state, "1") == 0) {
-                                            if (gamestart) {
-                                                free(gamestart);
-                                                gamestart = NULL;
-                                            }
-                                            if (active_app_name) {
-                                                free(active_app_name);
-                                                active_app_name = NULL;
-                                            }
-                                            game_pid_count = 0;
-                                            ctx->need_profile_checkup = true;
-                                        }
-                                    }
-                                }
-                                fclose(fp_ai);
-                            }
-                        } else if (strcmp(event->name, "update") == 0) {
-                            log_zenith(LOG_INFO, "Module update detected, exiting.");
-                            notify("Module Update",
-                                   "Please reboot your device to complete module update.", false,
-                                   0);
-                            systemv("setprop persist.sys.azenith.service \"\"");
-                            systemv("setprop persist.sys.azenith.state stopped");
-                            return true;
-                        } else if (strcmp(event->name, "remove") == 0) {
-                            log_zenith(LOG_INFO, "Module is removed, exiting.");
-                            notify("Module Removed",
-                                   "Please reboot your device to complete module uninstallation.",
-                                   false, 0);
-                            return true;
-                        } else if (strcmp(event->name, "module.prop") == 0) {
-                            log_zenith(LOG_INFO, "module.prop modified...");
-                            is_kanged();
-                            check_module_version();
-                        } else if (strcmp(event->name, "reboot") == 0) {
-                            log_zenith(LOG_INFO, "Configuration updated, notify user to reboot");
-                            notify("Daemon Info",
-                                   "Configuration updated. Please reboot your device to take full "
-                                   "effect.",
-                                   false, 0);
-                        }
-
-                        if (strcmp(event->name, "freqoffset") == 0) {
-                            char path[PATH_MAX];
-                            snprintf(path, sizeof(path), "/data/adb/.config/AZenith/freqoffset");
-                            FILE* fp = fopen(path, "r");
-                            if (fp) {
-                                if (fgets(ctx->config_freqoffset, sizeof(ctx->config_freqoffset),
-                                          fp)) {
-                                    trim_newline(ctx->config_freqoffset);
-                                    log_zenith(LOG_INFO, "Inotify: freqoffset updated to [%s]",
-                                               ctx->config_freqoffset);
-                                }
-                                fclose(fp);
-                            }
-                        } else if (strcmp(event->name, "bypasspath") == 0) {
-                            char path[PATH_MAX];
-                            snprintf(path, sizeof(path),
-                                     "/data/adb/.config/AZenith/bypasschgconfig/bypasspath");
-                            FILE* fp = fopen(path, "r");
-                            if (fp) {
-                                if (fgets(ctx->config_bypasspath, sizeof(ctx->config_bypasspath),
-                                          fp)) {
-                                    trim_newline(ctx->config_bypasspath);
-                                }
-                                fclose(fp);
-                            }
-                        } else if (strcmp(event->name, "bypasschg") == 0) {
-                            char path[PATH_MAX], val[16] = {0};
-                            snprintf(path, sizeof(path),
-                                     "/data/adb/.config/AZenith/bypasschgconfig/bypasschg");
-                            FILE* fp = fopen(path, "r");
-                            if (fp) {
-                                if (fgets(val, sizeof(val), fp))
-                                    ctx->config_bypasschg = atoi(val);
-                                fclose(fp);
-                            }
-                        } else if (strcmp(event->name, "bypasschgthreshold") == 0) {
-                            char path[PATH_MAX], val[16] = {0};
-                            snprintf(
-                                path, sizeof(path),
-                                "/data/adb/.config/AZenith/bypasschgconfig/bypasschgthreshold");
-                            FILE* fp = fopen(path, "r");
-                            if (fp) {
-                                if (fgets(val, sizeof(val), fp))
-                                    ctx->config_bypasschgthreshold = atoi(val);
-                                fclose(fp);
-                            }
-                        }
+                    if (event->mask & IN_Q_OVERFLOW) [[clang::unlikely]] {
+                        log_zenith(LOG_WARN, "Inotify queue overflowed, re-reading watched files");
+                        dirty |= WATCH_RESYNC_MASK;
+                    } else {
+                        int file = match_watched_file(event);
+                        if (file >= 0)
+                            dirty |= 1u << file;
                     }
+                    events++;
                     ptr += sizeof(struct inotify_event) + event->len;
                 }
             }
+
+            if (dirty && events > __builtin_popcount(dirty))
+                log_verbose(LOG_DEBUG, "Inotify: %d events coalesced into %d file updates", events,
+                            __builtin_popcount(dirty));
+
+            for (; dirty; dirty &= dirty - 1) {
+                if (handle_watched_file(ctx, (WatchedFile)__builtin_ctz(dirty)))
+                    return true;
+            }
         }
+
+        if (pfds[6].revents & POLLIN)
+            timer_wheel_dispatch();
     }
+
+    /* Without a timerfd the poll timeout from timer_wheel_timeout() stands in for it */
+    if (ctx->timer_fd < 0 && ret >= 0)
+        timer_wheel_dispatch();
+
+    *woke = ctx->pending_events != 0;
+    for (int i = 0; ret > 0 && !*woke && i < 7 + MAX_GAME_PIDS; i++)
+        *woke = i != 3 && pfds[i].revents;
     return false;
 }
 
@@ -722,30 +1055,206 @@ static void handle_dynamic_bypass(DaemonContext* ctx) {
     }
 }
 
+/**
+ * @brief Records the outcome of a profile apply and schedules a retry if its settings script hung.
+ * @note A timed-out script was killed half way, so the profile is applied again as declared by
+ * profile_retry_policy.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param status Return value of run_profiler().
+ */
+static void check_profile_result(DaemonContext* ctx, int status) {
+    /* Every profile rewrites the cpufreq limits, the balance has to be checked again */
+    ctx->freqoffset_synced = false;
+
+    if (status != EXEC_TIMED_OUT) {
+        retry_reset(&ctx->profile_retry);
+        return;
+    }
+
+    int delay = retry_schedule(&ctx->profile_retry);
+    if (delay < 0) {
+        log_zenith(LOG_ERROR, "Profile settings timed out %d times, giving up until the next profile change",
+                   profile_retry_policy.max_attempts + 1);
+        return;
+    }
+
+    log_zenith(LOG_WARN, "Profile settings timed out, retrying in %d ms (%d/%d)", delay, ctx->profile_retry.attempt,
+               profile_retry_policy.max_attempts);
+}
+
+/**
+ * @brief Applies the settings script of the current profile again after it timed out.
+ * @note Timer callback of profile_retry.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void retry_profile(void* arg) {
+    DaemonContext* ctx = arg;
+    int status;
+    EXECUTE("Profile retry", status = run_profiler(ctx->cur_mode));
+    check_profile_result(ctx, status);
+}
+
+/**
+ * @brief Ends the screen-off grace period of a running game.
+ * @note Timer callback of grace_timer.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_grace_expired(void* arg) {
+    DaemonContext* ctx = arg;
+    log_zenith(LOG_INFO, "Grace period expired. Dropping Performance Profile.");
+    post_event(ctx, EVENT_GRACE_EXPIRED);
+}
+
+/**
+ * @brief Starts preloading the game once it had time to settle after launch.
+ * @note Timer callback of preload_timer.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_preload_due(void* arg) {
+    DaemonContext* ctx = arg;
+
+    PreloadArgs* p_args = malloc(sizeof(PreloadArgs));
+    if (!p_args) {
+        log_zenith(LOG_ERROR, "Failed to allocate memory for preload arguments");
+        return;
+    }
+    strncpy(p_args->package, ctx->preload_package, sizeof(p_args->package) - 1);
+    p_args->package[sizeof(p_args->package) - 1] = '\0';
+
+    pthread_t preload_thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    if (pthread_create(&preload_thread, &attr, async_preload_worker, p_args) != 0) {
+        log_zenith(LOG_ERROR, "Failed to spawn async preload thread");
+        free(p_args);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+/**
+ * @brief Restarts the game once its new renderer property is in place.
+ * @note Timer callback of renderer_timer.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_renderer_switched(void* arg) {
+    DaemonContext* ctx = arg;
+    restart_app(ctx->renderer_package);
+    timer_schedule(&ctx->respawn_timer, RENDERER_RESPAWN_WAIT_MS);
+}
+
+/**
+ * @brief Lets the main loop look up the PIDs of a game restarted for its renderer.
+ * @note Timer callback of respawn_timer.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_app_respawned(void* arg) {
+    DaemonContext* ctx = arg;
+    is_restarting_renderer = false;
+    post_event(ctx, EVENT_SPAWN_CHECK);
+}
+
+/**
+ * @brief Reloads the gamelist after its file stopped changing.
+ * @note Timer callback of gamelist_timer.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_gamelist_settled(void* arg) {
+    DaemonContext* ctx = arg;
+    reload_gamelist_cache(ctx);
+    post_event(ctx, EVENT_APP_STATE);
+}
+
+/**
+ * @brief Looks for the PIDs of a launching game again.
+ * @note Timer callback of spawn_retry.
+ * @param arg Pointer to DaemonContext structure.
+ */
+static void on_spawn_retry(void* arg) {
+    post_event(arg, EVENT_SPAWN_CHECK);
+}
+
+/**
+ * @brief Applies the freqoffset CPU limits when something they depend on changed.
+ * @note Applying is idempotent, so it only runs when the freqoffset, the profile or the screen
+ * state differ from the last apply, or a profile rewrote the limits meanwhile. Anything else would
+ * just rewrite every cpufreq policy with the same values and is counted as skipped.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param screen_state Current screen state.
+ */
+static void sync_freqoffset(DaemonContext* ctx, int screen_state) {
+    bool disabled = strcmp(ctx->config_freqoffset, "Disabled") == 0;
+    bool changed = strcmp(ctx->last_freqoffset, ctx->config_freqoffset) != 0;
+
+    /* Disabling restores the stock limits once, an active offset is kept on Balanced and Eco */
+    bool wanted = disabled ? changed
+                           : screen_state && (ctx->cur_mode == BALANCED_PROFILE || ctx->cur_mode == ECO_MODE);
+    strcpy(ctx->last_freqoffset, ctx->config_freqoffset);
+    if (!wanted)
+        return;
+
+    if (ctx->freqoffset_synced && !changed && ctx->freqoffset_mode == ctx->cur_mode &&
+        ctx->freqoffset_screen == screen_state) {
+        ctx->freqoffset_skipped++;
+        return;
+    }
+
+    run_profilesettings("applyfreqbalance");
+    ctx->freqoffset_synced = true;
+    ctx->freqoffset_mode = ctx->cur_mode;
+    ctx->freqoffset_screen = screen_state;
+    ctx->freqoffset_applies++;
+    log_verbose(LOG_DEBUG, "Freqoffset [%s] applied (%u applied, %u redundant skipped)", ctx->config_freqoffset,
+                ctx->freqoffset_applies, ctx->freqoffset_skipped);
+}
+
+/**
+ * @brief Marks the start of a transition for the setprop spawn count.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void begin_prop_count(DaemonContext* ctx) {
+    ctx->prop_mark = prop_set_count();
+}
+
+/**
+ * @brief Records how many setprop spawns the transition saved by setting properties directly.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param profile Profile name for the log line.
+ */
+static void end_prop_count(DaemonContext* ctx, const char* profile) {
+    uint32_t saved = prop_set_count() - ctx->prop_mark;
+    ctx->prop_transitions++;
+    ctx->prop_spawns_saved += saved;
+    if (saved > 0)
+        log_verbose(LOG_DEBUG, "%s removed %u setprop spawns", profile, saved);
+}
+
 /**
  * @brief Applies system tuning parameters specifically for Performance Mode.
  * @param ctx Pointer to DaemonContext structure.
  */
 static void apply_performance_profile(DaemonContext* ctx) {
+    notify_begin_transition();
+    begin_prop_count(ctx);
     toast("Applying Performance Profile");
 
     ctx->cur_mode = PERFORMANCE_PROFILE;
-    ctx->need_profile_checkup = false;
 
     notify("Performance Profile", "Running at %s", false, 0,
            active_app_name ? active_app_name : gamestart);
+    notify_end_transition();
     log_zenith(LOG_INFO, "Applying performance profile for %s",
                active_app_name ? active_app_name : gamestart);
 
     if (IS_TRUE(opts.perf_lite_mode)) {
-        systemv("setprop persist.sys.azenithconf.litemode 1");
+        prop_set("persist.sys.azenithconf.litemode", "1");
     } else if (IS_FALSE(opts.perf_lite_mode)) {
-        systemv("setprop persist.sys.azenithconf.litemode 0");
+        prop_set("persist.sys.azenithconf.litemode", "0");
     } else {
         char lite_prop[PROP_VALUE_MAX] = {0};
-        __system_property_get("persist.sys.azenithconf.cpulimit", lite_prop);
-        systemv("setprop persist.sys.azenithconf.litemode %s",
-                (strcmp(lite_prop, "1") == 0) ? "1" : "0");
+        prop_cache_get(PROP_CPULIMIT, lite_prop);
+        prop_set("persist.sys.azenithconf.litemode", (strcmp(lite_prop, "1") == 0) ? "1" : "0");
     }
 
     if (ctx->saved_zen_mode < 0) {
@@ -759,7 +1268,7 @@ static void apply_performance_profile(DaemonContext* ctx) {
         ctx->dnd_enabled = true;
     } else if (!IS_FALSE(opts.dnd_on_gaming)) {
         char dnd_state[PROP_VALUE_MAX] = {0};
-        __system_property_get("persist.sys.azenithconf.dnd", dnd_state);
+        prop_cache_get(PROP_DND, dnd_state);
         if (strcmp(dnd_state, "1") == 0) {
             if (ctx->saved_zen_mode == 0) {
                 systemv("sys.azenith-utilityconf enableDND");
@@ -768,7 +1277,9 @@ static void apply_performance_profile(DaemonContext* ctx) {
         }
     }
 
-    EXECUTE("Performance Profile", run_profiler(PERFORMANCE_PROFILE));
+    int status;
+    EXECUTE("Performance Profile", status = run_profiler(PERFORMANCE_PROFILE));
+    check_profile_result(ctx, status);
 
     if (!IS_DEFAULT(opts.refresh_rate)) {
         int rr = atoi(opts.refresh_rate);
@@ -781,7 +1292,7 @@ static void apply_performance_profile(DaemonContext* ctx) {
     bool is_preload_active = false;
     if (!IS_FALSE(opts.game_preload)) {
         char preload_active[PROP_VALUE_MAX] = {0};
-        if (__system_property_get("persist.sys.azenithconf.APreload", preload_active) > 0) {
+        if (prop_cache_get(PROP_APRELOAD, preload_active) > 0) {
             is_preload_active = (strcmp(preload_active, "1") == 0);
         }
     }
@@ -790,25 +1301,11 @@ static void apply_performance_profile(DaemonContext* ctx) {
         notify("AZenith Preload", "Preloading initiated for: %s", true, 10000,
                active_app_name ? active_app_name : gamestart);
 
-        PreloadArgs* p_args = malloc(sizeof(PreloadArgs));
-        if (p_args) {
-            strncpy(p_args->package, gamestart, sizeof(p_args->package) - 1);
-            p_args->package[sizeof(p_args->package) - 1] = '\0';
-
-            pthread_t preload_thread;
-            pthread_attr_t attr;
-            pthread_attr_init(&attr);
-            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-
-            if (pthread_create(&preload_thread, &attr, async_preload_worker, p_args) != 0) {
-                log_zenith(LOG_ERROR, "Failed to spawn async preload thread");
-                free(p_args);
-            }
-            pthread_attr_destroy(&attr);
-        } else {
-            log_zenith(LOG_ERROR, "Failed to allocate memory for preload arguments");
-        }
+        snprintf(ctx->preload_package, sizeof(ctx->preload_package), "%s", gamestart);
+        timer_schedule(&ctx->preload_timer, PRELOAD_DELAY_MS);
     }
+
+    end_prop_count(ctx, "Performance Profile");
 }
 
 /**
@@ -819,12 +1316,15 @@ static void apply_eco_profile(DaemonContext* ctx) {
     if (ctx->cur_mode == ECO_MODE)
         return;
 
+    notify_begin_transition();
+    begin_prop_count(ctx);
     toast("Applying Eco Mode");
 
     ctx->cur_mode = ECO_MODE;
-    ctx->need_profile_checkup = false;
+    timer_cancel(&ctx->preload_timer);
 
     notify("ECO Mode", "System is now at Endurance state", false, 0);
+    notify_end_transition();
     log_zenith(LOG_INFO, "Applying ECO Mode");
 
     if (ctx->saved_refresh_rate > 0) {
@@ -858,7 +1358,10 @@ static void apply_eco_profile(DaemonContext* ctx) {
         memset(ctx->saved_renderer, 0, sizeof(ctx->saved_renderer));
     }
 
-    EXECUTE("ECO Mode", run_profiler(ECO_MODE));
+    int status;
+    EXECUTE("ECO Mode", status = run_profiler(ECO_MODE));
+    check_profile_result(ctx, status);
+    end_prop_count(ctx, "ECO Mode");
 }
 
 /**
@@ -869,12 +1372,15 @@ static void apply_balanced_profile(DaemonContext* ctx) {
     if (ctx->is_initialize_complete && ctx->cur_mode == BALANCED_PROFILE)
         return;
 
+    notify_begin_transition();
+    begin_prop_count(ctx);
     toast("Applying Balanced Profile");
 
     ctx->cur_mode = BALANCED_PROFILE;
-    ctx->need_profile_checkup = false;
+    timer_cancel(&ctx->preload_timer);
 
     notify("Balanced Profile", "System is now at Optimal state", false, 0);
+    notify_end_transition();
     log_zenith(LOG_INFO, "Applying balanced profile");
 
     if (ctx->saved_refresh_rate > 0) {
@@ -908,12 +1414,530 @@ static void apply_balanced_profile(DaemonContext* ctx) {
         memset(ctx->saved_renderer, 0, sizeof(ctx->saved_renderer));
     }
 
-    EXECUTE("Balanced Profile", run_profiler(BALANCED_PROFILE));
+    int status;
+    EXECUTE("Balanced Profile", status = run_profiler(BALANCED_PROFILE));
+    check_profile_result(ctx, status);
 
     if (!ctx->is_initialize_complete) {
         notify("Daemon Info", "AZenith is running successfully", false, 60000);
         ctx->is_initialize_complete = true;
     }
+    end_prop_count(ctx, "Balanced Profile");
+}
+
+/*
+ * The profile decisions of the main loop are a state machine: every source of change posts a typed
+ * event, and the loop routes each pending event through one transition table lookup. An empty slot
+ * means the event cannot change anything in that state, so it is dropped without looking at the
+ * focused app or touching a profile.
+ */
+typedef DaemonState (*TransitionFn)(DaemonContext* ctx);
+
+static const TransitionFn transition_table[STATE_COUNT][EVENT_COUNT] = {
+    [STATE_BOOT] = {
+        [EVENT_APP_STATE] = finish_boot,
+    },
+    [STATE_BALANCED] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+        [EVENT_SCREEN_ON] = evaluate_profile,
+        [EVENT_APP_STATE] = evaluate_profile,
+    },
+    [STATE_ECO] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+        [EVENT_SCREEN_ON] = evaluate_profile,
+        [EVENT_APP_STATE] = evaluate_profile,
+    },
+    [STATE_LAUNCHING] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+        [EVENT_SCREEN_OFF] = begin_grace,
+        [EVENT_SCREEN_ON] = evaluate_profile,
+        [EVENT_GAME_GONE] = evaluate_profile,
+        [EVENT_APP_STATE] = evaluate_profile,
+        [EVENT_SPAWN_CHECK] = continue_launch,
+    },
+    [STATE_PERFORMANCE] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+        [EVENT_SCREEN_OFF] = begin_grace,
+        [EVENT_GAME_GONE] = evaluate_profile,
+        [EVENT_APP_STATE] = evaluate_profile,
+        [EVENT_SPAWN_CHECK] = check_game_pids,
+    },
+    [STATE_GRACE] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+        [EVENT_SCREEN_ON] = end_grace,
+        [EVENT_GAME_GONE] = evaluate_profile,
+        [EVENT_APP_STATE] = evaluate_profile,
+        [EVENT_GRACE_EXPIRED] = evaluate_profile,
+        [EVENT_SPAWN_CHECK] = check_game_pids,
+    },
+    [STATE_MANUAL] = {
+        [EVENT_AUTO_MODE] = toggle_auto_mode,
+    },
+};
+
+static const char* const state_names[STATE_COUNT] = {"Boot",        "Balanced", "Eco",   "Launching",
+                                                     "Performance", "Grace",    "Manual"};
+static const char* const event_names[EVENT_COUNT] = {"auto mode",  "screen off",    "screen on",  "game gone",
+                                                     "app status", "grace expired", "spawn check"};
+
+/**
+ * @brief Queues an event for the state machine.
+ * @note Events coalesce until dispatch_events() runs, posting one twice is free.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param event Event to post.
+ */
+static void post_event(DaemonContext* ctx, DaemonEvent event) {
+    ctx->pending_events |= 1u << event;
+}
+
+/**
+ * @brief Posts what a change of the tracked game PIDs means for the state machine.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param had_game Whether a game was tracked before the change.
+ */
+static void post_game_pids_event(DaemonContext* ctx, bool had_game) {
+    if (gamestart)
+        post_event(ctx, EVENT_SPAWN_CHECK);
+    else if (had_game)
+        post_event(ctx, EVENT_GAME_GONE);
+}
+
+/**
+ * @brief Records a state change and its latency.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param event Event that caused the change.
+ * @param next State the transition ended in.
+ * @param start exec_clock_ns() when the event was dispatched.
+ */
+static void record_transition(DaemonContext* ctx, DaemonEvent event, DaemonState next, uint64_t start) {
+    DaemonState prev = ctx->state;
+    uint64_t now = exec_clock_ns();
+    uint64_t latency = now - start;
+    uint64_t dwell = start - ctx->state_since_ns;
+
+    TransitionStat* stat = &ctx->transitions[prev][next];
+    stat->count++;
+    stat->total_ns += latency;
+    stat->dwell_ns += dwell;
+    if (latency > stat->max_ns)
+        stat->max_ns = latency;
+
+    log_verbose(LOG_DEBUG, "State %s -> %s on %s in %.2f ms (%.1f ms in %s)", state_names[prev], state_names[next],
+                event_names[event], latency / 1e6, dwell / 1e6, state_names[prev]);
+
+    /* A launch runs from the event that found the game until Performance is applied */
+    if (next == STATE_LAUNCHING) {
+        ctx->launch_started_ns = start;
+    } else if (next == STATE_PERFORMANCE && prev != STATE_GRACE) {
+        uint64_t launch = now - (prev == STATE_LAUNCHING ? ctx->launch_started_ns : start);
+        ctx->launches.count++;
+        ctx->launches.total_ns += launch;
+        if (launch > ctx->launches.max_ns)
+            ctx->launches.max_ns = launch;
+        log_verbose(LOG_DEBUG, "Launch to Performance took %.1f ms", launch / 1e6);
+    }
+
+    ctx->state = next;
+    ctx->state_since_ns = now;
+}
+
+/**
+ * @brief Routes every pending event through the transition table.
+ * @note Events are taken lowest bit first, not in arrival order: DaemonEvent is a priority list, so
+ * Auto Mode and screen changes settle the state before app and PID events are looked at. Transitions
+ * may post further events, they are handled in the same pass.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void dispatch_events(DaemonContext* ctx) {
+    while (ctx->pending_events) {
+        DaemonEvent event = (DaemonEvent)__builtin_ctz(ctx->pending_events);
+        ctx->pending_events &= ctx->pending_events - 1;
+
+        TransitionFn transition = transition_table[ctx->state][event];
+        if (!transition)
+            continue;
+
+        uint64_t start = exec_clock_ns();
+        DaemonState next = transition(ctx);
+        if (next != ctx->state)
+            record_transition(ctx, event, next, start);
+    }
+}
+
+/**
+ * @brief Receives process events only while a game is launching or running.
+ * @note The proc connector reports every fork, exec and exit of the whole system, an idle daemon
+ * must not wake up for them.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void sync_proc_events(DaemonContext* ctx) {
+    if (ctx->proc_events_fd < 0)
+        return;
+
+    bool wanted = ctx->state == STATE_LAUNCHING || ctx->state == STATE_PERFORMANCE || ctx->state == STATE_GRACE;
+    if (wanted == ctx->proc_events_active)
+        return;
+
+    proc_events_set_active(ctx->proc_events_fd, wanted);
+    ctx->proc_events_active = wanted;
+}
+
+/**
+ * @brief Applies the first profile once the daemon is up.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return STATE_MANUAL if Auto Mode is off, STATE_BALANCED otherwise.
+ */
+static DaemonState finish_boot(DaemonContext* ctx) {
+    apply_balanced_profile(ctx);
+    if (strcmp(ctx->prev_ai_state, "0") == 0)
+        return STATE_MANUAL;
+
+    /* A game that is already focused is picked up right away */
+    post_event(ctx, EVENT_APP_STATE);
+    return STATE_BALANCED;
+}
+
+/**
+ * @brief Decides the profile from the focused app, the screen and the power state.
+ * @note A game keeps its profile after losing focus until its processes exit.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return The resulting state.
+ */
+static DaemonState evaluate_profile(DaemonContext* ctx) {
+    char* focused_game = get_gamestart(&opts, &current_system_cache);
+    if (focused_game) {
+        if (gamestart && strcmp(gamestart, focused_game) == 0) {
+            free(focused_game);
+        } else {
+            if (gamestart)
+                free(gamestart);
+            if (active_app_name)
+                free(active_app_name);
+            gamestart = focused_game;
+            active_app_name = strdup(current_system_cache.app_name);
+            log_zenith(LOG_INFO, "New game detected: %s", active_app_name ? active_app_name : gamestart);
+            game_pid_count = 0;
+            retry_reset(&ctx->spawn_retry);
+            timer_cancel(&ctx->renderer_timer);
+            timer_cancel(&ctx->respawn_timer);
+            is_restarting_renderer = false;
+            ctx->has_applied_renderer = false;
+        }
+    }
+
+    /* The game keeps Performance while the screen-off grace period runs */
+    bool screen_on = get_screenstate(&current_system_cache) || timer_pending(&ctx->grace_timer);
+    if (!gamestart || !screen_on)
+        return settle_idle(ctx);
+
+    if (ctx->cur_mode == PERFORMANCE_PROFILE && ctx->has_applied_renderer && game_pid_count > 0)
+        return timer_pending(&ctx->grace_timer) ? STATE_GRACE : STATE_PERFORMANCE;
+
+    return continue_launch(ctx);
+}
+
+/**
+ * @brief Applies Eco or Balanced when no game needs Performance.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return STATE_ECO or STATE_BALANCED.
+ */
+static DaemonState settle_idle(DaemonContext* ctx) {
+    timer_cancel(&ctx->grace_timer);
+    retry_reset(&ctx->spawn_retry);
+
+    if (get_low_power_state(&current_system_cache)) {
+        apply_eco_profile(ctx);
+        return STATE_ECO;
+    }
+    apply_balanced_profile(ctx);
+    return STATE_BALANCED;
+}
+
+/**
+ * @brief Takes a focused game one step closer to Performance.
+ * @note Switches the renderer first, then waits for the game's PIDs through spawn_retry.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return STATE_LAUNCHING while the game is not ready, the idle state if it never showed up,
+ * STATE_PERFORMANCE (or STATE_GRACE during a grace period) once Performance is applied.
+ */
+static DaemonState continue_launch(DaemonContext* ctx) {
+    if (!ctx->has_applied_renderer) {
+        ctx->has_applied_renderer = true;
+        if (!IS_DEFAULT(opts.renderer) && apply_smart_renderer(opts.renderer, ctx->saved_renderer)) {
+            log_zenith(LOG_INFO, "Changing renderer. Waiting for app to respawn...");
+            is_restarting_renderer = true;
+            game_pid_count = 0;
+            retry_reset(&ctx->spawn_retry);
+            snprintf(ctx->renderer_package, sizeof(ctx->renderer_package), "%s", gamestart);
+            timer_schedule(&ctx->renderer_timer, RENDERER_RESTART_DELAY_MS);
+        }
+    }
+
+    /* The game is restarted for its new renderer, PIDs are looked up once it respawned */
+    if (is_restarting_renderer)
+        return STATE_LAUNCHING;
+
+    if (game_pid_count == 0) [[clang::unlikely]] {
+        if (strcmp(current_system_cache.focused_app, gamestart) == 0) {
+            game_pid_count = get_pids_of(gamestart, game_pids, MAX_GAME_PIDS);
+            if (game_pid_count == 0 && ctx->proc_events_fd >= 0)
+                game_pid_count = proc_events_find_recent(current_game_uid(), game_pids, MAX_TRACK_PIDS);
+        }
+
+        if (game_pid_count == 0) {
+            /* Woken early by another event, the scheduled retry still stands */
+            if (timer_pending(&ctx->spawn_retry.timer))
+                return STATE_LAUNCHING;
+
+            if (retry_schedule(&ctx->spawn_retry) >= 0) {
+                log_zenith(LOG_WARN, "Waiting for %s to spawn (Retry %d/%d)...",
+                           active_app_name ? active_app_name : gamestart, ctx->spawn_retry.attempt,
+                           spawn_retry_policy.max_attempts);
+                return STATE_LAUNCHING;
+            }
+
+            log_zenith(LOG_ERROR, "Unable to fetch any PIDs for %s after %d retries. Dropping.",
+                       active_app_name ? active_app_name : gamestart, spawn_retry_policy.max_attempts);
+            free(gamestart);
+            gamestart = NULL;
+            if (active_app_name) {
+                free(active_app_name);
+                active_app_name = NULL;
+            }
+            return settle_idle(ctx);
+        }
+
+        retry_reset(&ctx->spawn_retry);
+        for (int i = 0; i < game_pid_count; i++) {
+            if (IS_TRUE(opts.app_priority)) {
+                set_priority(game_pids[i]);
+            } else if (!IS_FALSE(opts.app_priority)) {
+                char val[PROP_VALUE_MAX] = {0};
+                if (prop_cache_get(PROP_IOSCHED, val) > 0 && val[0] == '1') {
+                    set_priority(game_pids[i]);
+                }
+            }
+        }
+    }
+
+    apply_performance_profile(ctx);
+    return timer_pending(&ctx->grace_timer) ? STATE_GRACE : STATE_PERFORMANCE;
+}
+
+/**
+ * @brief Relaunches a running game once all of its PIDs are gone while it stays focused.
+ * @note Also runs during the grace period, the game may respawn while the screen is off.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return The resulting state.
+ */
+static DaemonState check_game_pids(DaemonContext* ctx) {
+    if (game_pid_count > 0)
+        return timer_pending(&ctx->grace_timer) ? STATE_GRACE : STATE_PERFORMANCE;
+    return continue_launch(ctx);
+}
+
+/**
+ * @brief Starts the screen-off grace period of a game running at Performance.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return STATE_GRACE, or the decided state if Performance was not applied yet.
+ */
+static DaemonState begin_grace(DaemonContext* ctx) {
+    if (ctx->cur_mode != PERFORMANCE_PROFILE)
+        return evaluate_profile(ctx);
+
+    timer_schedule(&ctx->grace_timer, GRACE_PERIOD_MS);
+    log_zenith(LOG_INFO, "Screen OFF Event: Grace period started (%ds)...", GRACE_PERIOD_MS / 1000);
+    return STATE_GRACE;
+}
+
+/**
+ * @brief Aborts the grace period once the screen is back on.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return The decided state.
+ */
+static DaemonState end_grace(DaemonContext* ctx) {
+    log_zenith(LOG_INFO, "Screen ON Event: Grace period aborted. Keeping Performance Profile.");
+    timer_cancel(&ctx->grace_timer);
+    return evaluate_profile(ctx);
+}
+
+/**
+ * @brief Reapplies Balanced after Auto Mode was switched, prev_ai_state already holds the new value.
+ * @param ctx Pointer to DaemonContext structure.
+ * @return STATE_MANUAL if Auto Mode is now off, the decided state otherwise.
+ */
+static DaemonState toggle_auto_mode(DaemonContext* ctx) {
+    log_zenith(LOG_INFO, "Dynamic profile toggled, Reapplying Balanced Profiles");
+    timer_cancel(&ctx->grace_timer);
+    ctx->cur_mode = PERFCOMMON;
+    apply_balanced_profile(ctx);
+    if (strcmp(ctx->prev_ai_state, "0") == 0)
+        return STATE_MANUAL;
+
+    if (strcmp(ctx->prev_ai_state, "1") == 0) {
+        if (gamestart) {
+            free(gamestart);
+            gamestart = NULL;
+        }
+        if (active_app_name) {
+            free(active_app_name);
+            active_app_name = NULL;
+        }
+        game_pid_count = 0;
+    }
+    return evaluate_profile(ctx);
+}
+
+/**
+ * @brief Sends the state transition table to a control client, the answer still needs
+ * control_socket_reply().
+ * @param ctx Pointer to DaemonContext structure.
+ * @param client Client socket.
+ * @param reset Set to true to clear the counters after reporting them.
+ */
+static void report_transitions(DaemonContext* ctx, int client, bool reset) {
+    control_socket_send(client, "%-28s %6s %9s %9s %10s", "TRANSITION", "COUNT", "AVG ms", "MAX ms", "DWELL ms");
+    for (int from = 0; from < STATE_COUNT; from++) {
+        for (int to = 0; to < STATE_COUNT; to++) {
+            const TransitionStat* stat = &ctx->transitions[from][to];
+            if (!stat->count)
+                continue;
+
+            char name[32];
+            snprintf(name, sizeof(name), "%s -> %s", state_names[from], state_names[to]);
+            control_socket_send(client, "%-28s %6u %9.2f %9.2f %10.1f", name, stat->count,
+                                stat->total_ns / 1e6 / stat->count, stat->max_ns / 1e6,
+                                stat->dwell_ns / 1e6 / stat->count);
+        }
+    }
+    if (ctx->launches.count)
+        control_socket_send(client, "Launch to Performance: %u launches, %.1f ms avg, %.1f ms max",
+                            ctx->launches.count, ctx->launches.total_ns / 1e6 / ctx->launches.count,
+                            ctx->launches.max_ns / 1e6);
+    if (ctx->prop_transitions)
+        control_socket_send(client, "Setprop spawns removed: %llu across %u profile transitions",
+                            (unsigned long long)ctx->prop_spawns_saved, ctx->prop_transitions);
+    control_socket_send(client, "");
+
+    if (reset) {
+        memset(ctx->transitions, 0, sizeof(ctx->transitions));
+        memset(&ctx->launches, 0, sizeof(ctx->launches));
+        ctx->prop_transitions = 0;
+        ctx->prop_spawns_saved = 0;
+    }
+}
+
+/**
+ * @brief Applies a profile requested through the control socket and answers the client.
+ * @note Balanced and Eco go through the regular transitions so refresh rate, DND and renderer
+ * state saved in the context are restored.
+ * @param ctx Pointer to DaemonContext structure.
+ * @param client Client socket waiting for the result.
+ * @param profile Requested ProfileMode.
+ */
+static void handle_profile_request(DaemonContext* ctx, int client, int profile) {
+    char ai_state[PROP_VALUE_MAX] = {0};
+    __system_property_get("persist.sys.azenithconf.AIenabled", ai_state);
+    if (strcmp(ai_state, "1") == 0) {
+        control_socket_reply(client, 1, "ERROR: Auto Mode is enabled.\n       Manual profile selection is blocked.");
+        return;
+    }
+
+    switch (profile) {
+        case PERFORMANCE_PROFILE: {
+            notify_begin_transition();
+            begin_prop_count(ctx);
+            ctx->cur_mode = PERFORMANCE_PROFILE;
+            notify("Performance Profile", "System is now at Powerful state", false, 0);
+            notify_end_transition();
+            log_zenith(LOG_INFO, "Applying Performance Profile via execute");
+
+            char lite_prop[PROP_VALUE_MAX] = {0};
+            prop_cache_get(PROP_CPULIMIT, lite_prop);
+            prop_set("persist.sys.azenithconf.litemode", strcmp(lite_prop, "1") == 0 ? "1" : "0");
+            int status;
+            EXECUTE("Performance Profile", status = run_profiler(PERFORMANCE_PROFILE));
+            check_profile_result(ctx, status);
+            end_prop_count(ctx, "Performance Profile");
+            if (status == EXEC_TIMED_OUT)
+                control_socket_reply(client, 1, "ERROR: Performance Profile timed out, retrying in background");
+            else
+                control_socket_reply(client, 0, "Applying Performance Profile");
+            break;
+        }
+        case BALANCED_PROFILE:
+            log_zenith(LOG_INFO, "Applying Balanced Profile via execute");
+            ctx->cur_mode = PERFCOMMON;
+            apply_balanced_profile(ctx);
+            control_socket_reply(client, 0, "Applying Balanced Profile");
+            break;
+        case ECO_MODE:
+            log_zenith(LOG_INFO, "Applying Eco Mode via execute");
+            ctx->cur_mode = PERFCOMMON;
+            apply_eco_profile(ctx);
+            control_socket_reply(client, 0, "Applying Eco Mode");
+            break;
+        default:
+            control_socket_reply(client, 1, "Invalid profiles.");
+            break;
+    }
+}
+
+/**
+ * @brief Serves every pending request on the control socket.
+ * @param ctx Pointer to DaemonContext structure.
+ */
+static void handle_control_requests(DaemonContext* ctx) {
+    static const char* const profile_names[] = {"Initializing", "Performance", "Balanced", "Eco Mode"};
+    ControlRequest req;
+    int client;
+
+    while ((client = control_socket_accept(ctx->control_fd, &req)) >= 0) {
+        switch (req.command) {
+            case CTL_PROFILE:
+                handle_profile_request(ctx, client, req.arg);
+                break;
+            case CTL_STATUS: {
+                unsigned int ticket;
+                const GameList* list = gamelist_acquire(&ticket);
+                int games = list ? list->count : 0;
+                gamelist_release(ticket);
+
+                int mode = ctx->cur_mode;
+                control_socket_reply(client, 0,
+                                     "Profile: %s\nState: %s\nAuto mode: %s\nGame: %s (%d PIDs)\nScreen: %s\n"
+                                     "Gamelist: %d entries\nFreqoffset: %s (%u applied, %u redundant skipped)",
+                                     mode >= 0 && mode <= ECO_MODE ? profile_names[mode] : "Unknown",
+                                     state_names[ctx->state],
+                                     strcmp(ctx->prev_ai_state, "1") == 0 ? "on" : "off",
+                                     active_app_name ? active_app_name : gamestart ? gamestart : "none", game_pid_count,
+                                     ctx->prev_screen_state > 0 ? "on" : "off", games, ctx->config_freqoffset,
+                                     ctx->freqoffset_applies, ctx->freqoffset_skipped);
+                break;
+            }
+            case CTL_RELOAD: {
+                load_initial_config_files(ctx);
+                reload_gamelist_cache(ctx);
+                read_app_status(&current_system_cache);
+                post_event(ctx, EVENT_APP_STATE);
+
+                unsigned int ticket;
+                const GameList* list = gamelist_acquire(&ticket);
+                int games = list ? list->count : 0;
+                gamelist_release(ticket);
+                control_socket_reply(client, 0, "Configuration reloaded (%d games)", games);
+                break;
+            }
+            case CTL_STATS:
+                report_transitions(ctx, client, req.arg != 0);
+                shell_pool_stats_report(client, req.arg != 0);
+                exec_stats_report(client, req.arg != 0);
+                break;
+            default:
+                control_socket_reply(client, 1, "Unknown command %d", req.command);
+                break;
+        }
+    }
 }
 
 /**
@@ -925,16 +1949,23 @@ int main_daemon(void) {
 
     if (daemon(0, 0)) {
         log_zenith(LOG_FATAL, "Unable to daemonize service");
-        systemv("setprop persist.sys.azenith.service \"\"");
-        systemv("setprop persist.sys.azenith.state stopped");
+        prop_set("persist.sys.azenith.service", "");
+        prop_set("persist.sys.azenith.state", "stopped");
         return 1;
     }
 
     signal(SIGINT, sighandler);
     signal(SIGTERM, sighandler);
 
+    log_writer_start();
+    binlog_open();
+    log_ingest_start();
+    shell_pool_init(SHELL_POOL_SIZE);
+    notify_dispatch_start();
+
     DaemonContext ctx;
     init_daemon_context(&ctx);
+    ctx.timer_fd = timer_wheel_open();
 
     wait_for_java_companion(&ctx);
 
@@ -952,14 +1983,13 @@ int main_daemon(void) {
     log_zenith(LOG_INFO, "Daemon started as PID %d", getpid());
     setspid();
 
-    systemv("setprop persist.sys.rianixia.learning_enabled true");
-    systemv("setprop persist.sys.azenith.state running");
+    prop_set("persist.sys.rianixia.learning_enabled", "true");
+    prop_set("persist.sys.azenith.state", "running");
     notify("Initializing...", "Starting AZenith service...", false, 0);
 
-    systemv(
-        "setprop persist.sys.rianixia.thermalcore-bigdata.path /data/adb/.config/AZenith/debug");
+    prop_set("persist.sys.rianixia.thermalcore-bigdata.path", "/data/adb/.config/AZenith/debug");
     runthermalcore();
-    run_profiler(PERFCOMMON);
+    check_profile_result(&ctx, run_profiler(PERFCOMMON));
     systemv("sys.azenith-utilityconf FSTrim");
 
     FILE* fp_ai_init = fopen(DAEMON_MODES, "r");
@@ -973,7 +2003,13 @@ int main_daemon(void) {
     load_initial_config_files(&ctx);
 
     log_zenith(LOG_INFO, "Reading initial applist status...");
+    ctx.app_state_fd = app_state_channel_open();
+    ctx.proc_events_fd = proc_events_open();
+    ctx.proc_events_active = ctx.proc_events_fd >= 0;
+    ctx.prop_change_fd = prop_cache_watch_start();
+    ctx.control_fd = control_socket_open();
     read_app_status(&current_system_cache);
+    rebuild_process_table();
     reload_gamelist_cache(&ctx);
 
     log_zenith(LOG_INFO, "Successfully read applist. Starting main monitoring loop...");
@@ -981,197 +2017,61 @@ int main_daemon(void) {
     is_kanged();
     check_module_version();
 
-    ctx.need_profile_checkup = true;
-    bool need_loop = true;
+    post_event(&ctx, EVENT_APP_STATE);
+    bool first_pass = true;
 
     /* Main Daemon Loop */
     while (1) {
-        int poll_timeout = -1;
-        if (need_loop) {
-            poll_timeout = 0;
-        } else if (ctx.grace_period_active) {
-            double elapsed = difftime(time(NULL), ctx.screen_off_timer);
-            if (elapsed < 10.0) {
-                poll_timeout = (int)((10.0 - elapsed) * 1000);
-            } else {
-                poll_timeout = 0;
-            }
-        }
-
-        bool should_exit = process_inotify_events(inotify_fd, &ctx, poll_timeout);
-        need_loop = false;
+        /* Grace periods, spawn and profile retries come back through the timer wheel */
+        bool woke;
+        bool should_exit = process_inotify_events(inotify_fd, &ctx, first_pass ? 0 : timer_wheel_timeout(), &woke);
+        first_pass = false;
 
         if (java_daemon_died) {
             log_zenith(
                 LOG_FATAL,
                 "Java daemon lock released, companion daemon exited or crashed, stopping daemon");
             notify("Daemon Error", "Java companion daemon crashed. Stopping AZenith.", false, 0);
-            systemv("setprop persist.sys.azenith.service \"\"");
-            systemv("setprop persist.sys.azenith.state stopped");
+            prop_set("persist.sys.azenith.service", "");
+            prop_set("persist.sys.azenith.state", "stopped");
             break;
         }
 
         if (should_exit)
             break;
 
-        int real_screen_state = get_screenstate(&current_system_cache);
-
-        if (strcmp(ctx.config_freqoffset, "Disabled") == 0) {
-            if (strcmp(ctx.last_freqoffset, "Disabled") != 0) {
-                systemv("sys.azenith-profilesettings applyfreqbalance");
-            }
-        } else if (real_screen_state &&
-                   (ctx.cur_mode == BALANCED_PROFILE || ctx.cur_mode == ECO_MODE)) {
-            systemv("sys.azenith-profilesettings applyfreqbalance");
-        }
-        strcpy(ctx.last_freqoffset, ctx.config_freqoffset);
-
-        handle_dynamic_bypass(&ctx);
-
-        if (ctx.is_initialize_complete && strcmp(ctx.prev_ai_state, "0") == 0) {
+        /* Foreign process events cannot change the screen, the config or the profile */
+        if (!woke)
             continue;
-        }
-
-        if (ctx.need_profile_checkup) {
-            char* current_focused_game = get_gamestart(&opts, &current_system_cache);
-            if (current_focused_game) {
-                if (gamestart && strcmp(gamestart, current_focused_game) == 0) {
-                    free(current_focused_game);
-                    ctx.need_profile_checkup = false;
-                } else {
-                    if (gamestart)
-                        free(gamestart);
-                    if (active_app_name)
-                        free(active_app_name);
-                    gamestart = current_focused_game;
-                    active_app_name = strdup(current_system_cache.app_name);
-                    log_zenith(LOG_INFO, "New game detected: %s",
-                               active_app_name ? active_app_name : gamestart);
-                    game_pid_count = 0;
-                    ctx.pid_retries = 0;
-                    ctx.has_applied_renderer = false;
-                    ctx.need_profile_checkup = true;
-                }
-            } else if (ctx.cur_mode != BALANCED_PROFILE && ctx.cur_mode != ECO_MODE) {
-                ctx.need_profile_checkup = false;
-            }
-        }
-
-        int effective_screen_state = real_screen_state;
 
+        int real_screen_state = get_screenstate(&current_system_cache);
         if (real_screen_state != ctx.prev_screen_state) {
-            if (real_screen_state == 0) {
-                if (ctx.cur_mode == PERFORMANCE_PROFILE) {
-                    ctx.screen_off_timer = time(NULL);
-                    ctx.grace_period_active = true;
-                    log_zenith(LOG_INFO, "Screen OFF Event: Grace period started (10s)...");
-                }
-            } else {
-                if (ctx.grace_period_active) {
-                    log_zenith(
-                        LOG_INFO,
-                        "Screen ON Event: Grace period aborted. Keeping Performance Profile.");
-                    ctx.grace_period_active = false;
-                }
-                ctx.screen_off_timer = 0;
-                ctx.need_profile_checkup = true;
-            }
+            post_event(&ctx, real_screen_state ? EVENT_SCREEN_ON : EVENT_SCREEN_OFF);
             ctx.prev_screen_state = real_screen_state;
         }
 
-        if (ctx.grace_period_active) {
-            if (difftime(time(NULL), ctx.screen_off_timer) < 10.0) {
-                effective_screen_state = 1;
-            } else {
-                log_zenith(LOG_INFO, "Grace period expired. Dropping Performance Profile.");
-                ctx.grace_period_active = false;
-                ctx.screen_off_timer = 0;
-                effective_screen_state = 0;
-                ctx.need_profile_checkup = true;
-            }
-        }
-
-        if (ctx.is_initialize_complete && ctx.cur_mode != PERFORMANCE_PROFILE &&
-            gamestart == NULL && !ctx.need_profile_checkup) {
-            continue;
-        }
-
-        if (ctx.is_initialize_complete && gamestart && effective_screen_state) {
-            if (!ctx.need_profile_checkup && ctx.cur_mode == PERFORMANCE_PROFILE &&
-                ctx.has_applied_renderer && game_pid_count > 0) {
-                continue;
-            }
-
-            bool is_renderer_changing = false;
-
-            if (!ctx.has_applied_renderer) {
-                is_restarting_renderer = true;
-                if (!IS_DEFAULT(opts.renderer)) {
-                    is_renderer_changing =
-                        apply_smart_renderer(opts.renderer, gamestart, ctx.saved_renderer);
-                }
-
-                if (is_renderer_changing) {
-                    log_zenith(LOG_INFO, "Changing renderer. Waiting for app to respawn...");
-                    usleep(500000);
-                    game_pid_count = 0;
-                    ctx.pid_retries = 0;
-                }
-                is_restarting_renderer = false;
-                ctx.has_applied_renderer = true;
-            }
+        sync_freqoffset(&ctx, real_screen_state);
 
-            if (game_pid_count == 0) [[clang::unlikely]] {
-                if (strcmp(current_system_cache.focused_app, gamestart) == 0) {
-                    game_pid_count = get_pids_of(gamestart, game_pids, MAX_GAME_PIDS);
-                }
-
-                if (game_pid_count == 0) {
-                    if (ctx.pid_retries < 5) {
-                        ctx.pid_retries++;
-                        log_zenith(LOG_WARN, "Waiting for %s to spawn (Retry %d/5)...",
-                                   active_app_name ? active_app_name : gamestart, ctx.pid_retries);
-                        need_loop = true;
-                        continue;
-                    } else {
-                        log_zenith(LOG_ERROR,
-                                   "Unable to fetch any PIDs for %s after 5 retries. Dropping.",
-                                   active_app_name ? active_app_name : gamestart);
-                        free(gamestart);
-                        gamestart = NULL;
-                        if (active_app_name) {
-                            free(active_app_name);
-                            active_app_name = NULL;
-                        }
-                        ctx.pid_retries = 0;
-                        ctx.need_profile_checkup = true;
-                        continue;
-                    }
-                }
-
-                ctx.pid_retries = 0;
-                for (int i = 0; i < game_pid_count; i++) {
-                    if (IS_TRUE(opts.app_priority)) {
-                        set_priority(game_pids[i]);
-                    } else if (!IS_FALSE(opts.app_priority)) {
-                        char val[PROP_VALUE_MAX] = {0};
-                        if (__system_property_get("persist.sys.azenithconf.iosched", val) > 0 &&
-                            val[0] == '1') {
-                            set_priority(game_pids[i]);
-                        }
-                    }
-                }
-            }
-            apply_performance_profile(&ctx);
+        handle_dynamic_bypass(&ctx);
 
-        } else if (ctx.is_initialize_complete && get_low_power_state(&current_system_cache)) {
-            apply_eco_profile(&ctx);
-        } else {
-            apply_balanced_profile(&ctx);
-        }
+        dispatch_events(&ctx);
+        sync_proc_events(&ctx);
     }
 
     if (inotify_fd >= 0)
         close(inotify_fd);
+    if (ctx.app_state_fd >= 0)
+        close(ctx.app_state_fd);
+    if (ctx.proc_events_fd >= 0)
+        close(ctx.proc_events_fd);
+    if (ctx.control_fd >= 0)
+        close(ctx.control_fd);
+    close_game_pidfds(&ctx);
+    timer_wheel_close();
+    exec_cancel_all();
+    notify_dispatch_stop();
+    shell_pool_log_stats();
+    shell_pool_shutdown();
+    profile_worker_shutdown();
     return 0;
 }
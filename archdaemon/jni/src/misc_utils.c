@@ -58,41 +58,25 @@ void escape_shell_string(char* dest, const char* src, size_t max_size) {
 
 /**
  * @brief Push an Android broadcast notification.
+ * @note Delivered asynchronously by the broadcast dispatcher when the daemon is running.
  * @param title Notification title.
  * @param fmt Format string for the message.
  * @param chrono Chronometer flag as bool.
  * @param timeout_ms Timeout in milliseconds (0 for no timeout).
  */
 void notify(const char* title, const char* fmt, bool chrono, int timeout_ms, ...) {
-    char message[512];
+    NotifyMessage msg = {0};
     va_list args;
     va_start(args, timeout_ms);
-    vsnprintf(message, sizeof(message), fmt, args);
+    vsnprintf(msg.text, sizeof(msg.text), fmt, args);
     va_end(args);
 
-    char safe_title[256];
-    char safe_message[2048];
-
-    escape_shell_string(safe_title, title, sizeof(safe_title));
-    escape_shell_string(safe_message, message, sizeof(safe_message));
-
-    const char* action = "zx.azenith.ACTION_MANAGE";
-    const char* component = "zx.azenith/zx.azenith.receiver.ZenithReceiver";
-    const char* chrono_str = chrono ? "true" : "false";
-
-    if (timeout_ms > 0) {
-        systemv("su -c \"am broadcast -a %s -n %s "
-                "--es notifytitle '%s' --es notifytext '%s' "
-                "--ez chrono_bool %s --es timeout '%d' "
-                ">/dev/null 2>&1\"",
-                action, component, safe_title, safe_message, chrono_str, timeout_ms);
-    } else {
-        systemv("su -c \"am broadcast -a %s -n %s "
-                "--es notifytitle '%s' --es notifytext '%s' "
-                "--ez chrono_bool %s "
-                ">/dev/null 2>&1\"",
-                action, component, safe_title, safe_message, chrono_str);
-    }
+    snprintf(msg.title, sizeof(msg.title), "%s", title);
+    msg.has_notify = true;
+    msg.chrono = chrono;
+    msg.timeout_ms = timeout_ms;
+
+    notify_dispatch_post(&msg);
 }
 
 /**
@@ -140,27 +124,28 @@ char* timern(void) {
             break;
     }
 
+    /* Commands still running would outlive us in their own process groups */
+    exec_cancel_all();
+
+    /* _exit() skips atexit handlers, write out queued log lines first */
+    log_writer_flush();
     _exit(EXIT_SUCCESS);
 }
 
 /**
  * @brief Display a toast notification using Zenith receiver.
+ * @note Delivered asynchronously by the broadcast dispatcher when the daemon is running.
  * @param message Message to display.
  */
 void toast(const char* message) {
     char val[PROP_VALUE_MAX] = {0};
 
-    if (__system_property_get("persist.sys.azenithconf.showtoast", val) > 0 && val[0] == '1') {
-        int exit = systemv("su -c \"am broadcast "
-                           "-a zx.azenith.ACTION_MANAGE "
-                           "-n zx.azenith/.receiver.ZenithReceiver "
-                           "--es toasttext '%s' "
-                           ">/dev/null 2>&1\"",
-                           message);
+    if (prop_cache_get(PROP_SHOWTOAST, val) > 0 && val[0] == '1') {
+        NotifyMessage msg = {0};
+        snprintf(msg.toast, sizeof(msg.toast), "%s", message);
+        msg.has_toast = true;
 
-        if (exit != 0) [[clang::unlikely]] {
-            log_zenith(LOG_WARN, "Unable to send toast broadcast: %s", message);
-        }
+        notify_dispatch_post(&msg);
     }
 }
 
@@ -182,8 +167,8 @@ void is_kanged(void) {
 doorprize:
     log_zenith(LOG_FATAL, "Module modified by 3rd party, exiting.");
     notify("Daemon Error", "Trying to rename me?", true, 0);
-    systemv("setprop persist.sys.azenith.service \"\"");
-    systemv("setprop persist.sys.azenith.state stopped");
+    prop_set("persist.sys.azenith.service", "");
+    prop_set("persist.sys.azenith.state", "stopped");
     exit(EXIT_FAILURE);
 }
 
@@ -201,8 +186,8 @@ void check_module_version(void) {
         log_zenith(LOG_FATAL,
                    "AZenith version mismatch with daemon version! please reinstall the module!");
         notify("Daemon Error", "AZenith version mismatch, please reinstall!", true, 0);
-        systemv("setprop persist.sys.azenith.service \"\"");
-        systemv("setprop persist.sys.azenith.state stopped");
+        prop_set("persist.sys.azenith.service", "");
+        prop_set("persist.sys.azenith.state", "stopped");
         exit(EXIT_FAILURE);
     }
 }
@@ -211,21 +196,16 @@ void check_module_version(void) {
  * @brief Exits the program if the module state is set to "stopped" or is empty.
  */
 void checkstate(void) {
-    char state[64] = {0};
-    FILE* fp = popen("getprop persist.sys.azenith.state", "r");
-    if (fp) {
-        fgets(state, sizeof(state), fp);
-        pclose(fp);
-    }
-    state[strcspn(state, "\n")] = 0;
+    char state[PROP_VALUE_MAX] = {0};
+    __system_property_get("persist.sys.azenith.state", state);
     if (state[0] == '\0' || strcmp(state, "stopped") == 0) [[clang::unlikely]] {
         goto killsvc;
     }
     return;
 killsvc:
     log_zenith(LOG_FATAL, "Service killed by checkstate().");
-    systemv("setprop persist.sys.azenith.service \"\"");
-    systemv("setprop persist.sys.azenith.state stopped");
+    prop_set("persist.sys.azenith.service", "");
+    prop_set("persist.sys.azenith.state", "stopped");
     exit(EXIT_FAILURE);
 }
 
@@ -247,11 +227,9 @@ bool return_false(void) { return false; }
  * @brief Sets the service PID into the Android system properties.
  */
 void setspid(void) {
-    char cmd[128];
-    pid_t pid = getpid();
-
-    snprintf(cmd, sizeof(cmd), "setprop persist.sys.azenith.service %d", pid);
-    systemv(cmd);
+    char pid[16];
+    snprintf(pid, sizeof(pid), "%d", getpid());
+    prop_set("persist.sys.azenith.service", pid);
 }
 
 /**
@@ -262,22 +240,28 @@ void runthermalcore(void) {
     __system_property_get("persist.sys.azenithconf.thermalcore", thermalcore);
     if (strcmp(thermalcore, "1") == 0) {
         systemv("sys.azenith-rianixiathermalcore &");
-        FILE* fp = popen("pidof sys.azenith-rianixiathermalcore", "r");
-        if (fp == NULL) {
-            perror("pidof failed");
-            log_zenith(LOG_INFO, "Failed to run Thermalcore service");
-            return;
-        }
-        char pid_str[32] = {0};
-        if (fgets(pid_str, sizeof(pid_str), fp) != NULL) {
-            int pid = atoi(pid_str);
-            log_zenith(LOG_INFO, "Starting Thermalcore Service with pid %d", pid);
+        char* pid_str = execute_command("pidof sys.azenith-rianixiathermalcore");
+        if (pid_str && pid_str[0]) {
+            log_zenith(LOG_INFO, "Starting Thermalcore Service with pid %d", atoi(pid_str));
         } else {
             log_zenith(LOG_INFO, "Thermalcore Service started but PID not found");
         }
+        free(pid_str);
+    }
+}
 
-        pclose(fp);
+/**
+ * @brief Computes the 32-bit FNV-1a hash of a string.
+ * @param s The NUL-terminated string.
+ * @return The hash value.
+ */
+uint32_t fnv1a_hash(const char* s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
     }
+    return h;
 }
 
 /**
@@ -291,43 +275,3 @@ char* skip_space(char* p) {
     return p;
 }
 
-/**
- * @brief Extracts value from a "key: value" string format.
- * @param dest Destination buffer for the extracted value.
- * @param key_pos Pointer to the start of the key/string.
- * @param max_len Maximum length to copy into dest.
- */
-void extract_string_value(char* dest, const char* key_pos, size_t max_len) {
-    if (!key_pos) {
-        strncpy(dest, "default", max_len - 1);
-        dest[max_len - 1] = '\0';
-        return;
-    }
-
-    const char* colon = strchr(key_pos, ':');
-    if (!colon) {
-        strncpy(dest, "default", max_len - 1);
-        dest[max_len - 1] = '\0';
-        return;
-    }
-
-    const char* start = colon + 1;
-    while (*start == ' ' || *start == '\t')
-        start++;
-
-    if (*start == '\"')
-        start++;
-
-    const char* end = strchr(start, '\"');
-    if (!end) {
-        strncpy(dest, "default", max_len - 1);
-        dest[max_len - 1] = '\0';
-        return;
-    }
-
-    size_t len = end - start;
-    if (len >= max_len)
-        len = max_len - 1;
-    strncpy(dest, start, len);
-    dest[len] = '\0';
-}
@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+
+#define NOTIFY_QUEUE_SIZE 16
+
+static NotifyMessage queue[NOTIFY_QUEUE_SIZE];
+static int queue_head = 0;
+static int queue_count = 0;
+static unsigned int current_transition = 0;
+static unsigned int transition_seq = 0;
+static bool dispatcher_running = false;
+static bool dispatcher_stopping = false;
+static pthread_t dispatcher_thread;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+
+/* Room kept after each text extra for the chrono/timeout extras and the closing redirect */
+#define BROADCAST_TAIL_RESERVE 80
+#define BROADCAST_TEXT_RESERVE 160
+
+/**
+ * @brief Appends a string extra to the broadcast command, truncating its value to fit.
+ * @note The value is single-quoted inside the double-quoted su -c argument: a quote closes and
+ * reopens the word, and the characters double quotes still expand are backslash-escaped. A value
+ * that does not fit is cut at a UTF-8 character boundary instead of overflowing the command.
+ * @param cmd Command buffer.
+ * @param size Size of the command buffer.
+ * @param len Current command length, advanced by this call.
+ * @param key Extra name.
+ * @param value Extra value.
+ * @param reserve Bytes to leave free for whatever follows this extra.
+ */
+static void append_string_extra(char* cmd, size_t size, size_t* len, const char* key, const char* value,
+                                size_t reserve) {
+    int n = snprintf(cmd + *len, size - *len, "--es %s '", key);
+    if (n < 0 || *len + n + 2 + reserve >= size)
+        return;
+
+    size_t pos = *len + n;
+    size_t limit = size - reserve - 2;
+    size_t char_start = pos;
+    for (const unsigned char* c = (const unsigned char*)value; *c; c++) {
+        const char* out;
+        char single[3] = {0};
+        if (*c == '\'') {
+            out = "'\\''";
+        } else if (*c == '"' || *c == '$' || *c == '`' || *c == '\\') {
+            single[0] = '\\';
+            single[1] = *c;
+            out = single;
+        } else {
+            single[0] = *c;
+            out = single;
+        }
+
+        size_t out_len = strlen(out);
+        if (pos + out_len > limit) {
+            /* Never leave half of a multibyte character behind */
+            if ((*c & 0xC0) == 0x80)
+                pos = char_start;
+            break;
+        }
+        if ((*c & 0xC0) != 0x80)
+            char_start = pos;
+        memcpy(cmd + pos, out, out_len);
+        pos += out_len;
+    }
+
+    memcpy(cmd + pos, "' ", 3);
+    *len = pos + 2;
+}
+
+/**
+ * @brief Sends one (possibly coalesced) toast/notification broadcast to the Zenith receiver.
+ * @note Blocks for the whole am process lifetime, only call from the dispatcher or as a fallback.
+ * Bounded by NOTIFY_BROADCAST_TIMEOUT_MS so the exit flush cannot hold up shutdown for long.
+ * @param msg Pointer to the message to deliver.
+ */
+static void send_broadcast(const NotifyMessage* msg) {
+    char cmd[MAX_COMMAND_LENGTH];
+    size_t len = snprintf(cmd, sizeof(cmd), "su -c \"am broadcast -a zx.azenith.ACTION_MANAGE "
+                                            "-n zx.azenith/.receiver.ZenithReceiver ");
+
+    if (msg->has_toast)
+        append_string_extra(cmd, sizeof(cmd), &len, "toasttext", msg->toast,
+                            BROADCAST_TAIL_RESERVE + (msg->has_notify ? 2 * BROADCAST_TEXT_RESERVE : 0));
+
+    if (msg->has_notify) {
+        append_string_extra(cmd, sizeof(cmd), &len, "notifytitle", msg->title,
+                            BROADCAST_TAIL_RESERVE + BROADCAST_TEXT_RESERVE);
+        append_string_extra(cmd, sizeof(cmd), &len, "notifytext", msg->text, BROADCAST_TAIL_RESERVE);
+        len += snprintf(cmd + len, sizeof(cmd) - len, "--ez chrono_bool %s ", msg->chrono ? "true" : "false");
+        if (msg->timeout_ms > 0)
+            len += snprintf(cmd + len, sizeof(cmd) - len, "--es timeout '%d' ", msg->timeout_ms);
+    }
+    snprintf(cmd + len, sizeof(cmd) - len, ">/dev/null 2>&1\"");
+
+    int exit = systemv_timeout(NOTIFY_BROADCAST_TIMEOUT_MS, "%s", cmd);
+
+    if (exit != 0) [[clang::unlikely]] {
+        log_zenith(LOG_WARN, "Unable to send broadcast: %s", msg->has_notify ? msg->title : msg->toast);
+    }
+}
+
+/**
+ * @brief Dispatcher thread, delivers queued broadcasts so callers never wait on am.
+ * @param arg Unused.
+ * @return NULL
+ */
+static void* dispatcher_worker(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&queue_mutex);
+    while (1) {
+        /* Hold back the open transition so its toast and notification can still be coalesced */
+        while (!dispatcher_stopping &&
+               (queue_count == 0 || (current_transition != 0 && queue[queue_head].transition == current_transition)))
+            pthread_cond_wait(&queue_cond, &queue_mutex);
+
+        if (queue_count == 0 && dispatcher_stopping)
+            break;
+
+        NotifyMessage msg = queue[queue_head];
+        queue_head = (queue_head + 1) % NOTIFY_QUEUE_SIZE;
+        queue_count--;
+
+        pthread_mutex_unlock(&queue_mutex);
+        send_broadcast(&msg);
+        pthread_mutex_lock(&queue_mutex);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+    return NULL;
+}
+
+/**
+ * @brief Removes queued messages that belong to an older profile transition.
+ * @note Caller must hold queue_mutex.
+ * @param transition The transition id that is still current.
+ */
+static void drop_stale_locked(unsigned int transition) {
+    int kept = 0;
+    for (int i = 0; i < queue_count; i++) {
+        NotifyMessage* m = &queue[(queue_head + i) % NOTIFY_QUEUE_SIZE];
+        if (m->transition != 0 && m->transition != transition) {
+            log_verbose(LOG_DEBUG, "Dropped stale broadcast: %s", m->has_notify ? m->title : m->toast);
+            continue;
+        }
+        queue[(queue_head + kept) % NOTIFY_QUEUE_SIZE] = *m;
+        kept++;
+    }
+    queue_count = kept;
+}
+
+/**
+ * @brief Queues a toast/notification broadcast for the dispatcher thread.
+ * @note A toast and a notification of the same transition are coalesced into one broadcast. Falls
+ * back to a blocking broadcast when the dispatcher is not running (CLI invocations).
+ * @param msg Pointer to the message; its transition id is assigned here.
+ */
+void notify_dispatch_post(NotifyMessage* msg) {
+    pthread_mutex_lock(&queue_mutex);
+
+    if (!dispatcher_running || dispatcher_stopping) {
+        pthread_mutex_unlock(&queue_mutex);
+        send_broadcast(msg);
+        return;
+    }
+
+    msg->transition = current_transition;
+
+    if (msg->transition != 0) {
+        for (int i = 0; i < queue_count; i++) {
+            NotifyMessage* m = &queue[(queue_head + i) % NOTIFY_QUEUE_SIZE];
+            if (m->transition != msg->transition)
+                continue;
+
+            if (msg->has_toast && !m->has_toast && !msg->has_notify) {
+                memcpy(m->toast, msg->toast, sizeof(m->toast));
+                m->has_toast = true;
+                pthread_mutex_unlock(&queue_mutex);
+                return;
+            }
+            if (msg->has_notify && !m->has_notify && !msg->has_toast) {
+                memcpy(m->title, msg->title, sizeof(m->title));
+                memcpy(m->text, msg->text, sizeof(m->text));
+                m->chrono = msg->chrono;
+                m->timeout_ms = msg->timeout_ms;
+                m->has_notify = true;
+                pthread_mutex_unlock(&queue_mutex);
+                return;
+            }
+        }
+    }
+
+    if (queue_count == NOTIFY_QUEUE_SIZE) {
+        NotifyMessage* oldest = &queue[queue_head];
+        log_zenith(LOG_WARN, "Broadcast queue full, dropping: %s", oldest->has_notify ? oldest->title : oldest->toast);
+        queue_head = (queue_head + 1) % NOTIFY_QUEUE_SIZE;
+        queue_count--;
+    }
+
+    queue[(queue_head + queue_count) % NOTIFY_QUEUE_SIZE] = *msg;
+    queue_count++;
+
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+/**
+ * @brief Marks the start of a profile transition.
+ * @note Broadcasts still queued from an earlier transition are dropped, and everything posted until
+ * notify_end_transition() is tagged with the new transition.
+ */
+void notify_begin_transition(void) {
+    pthread_mutex_lock(&queue_mutex);
+    current_transition = ++transition_seq;
+    if (current_transition == 0)
+        current_transition = transition_seq = 1;
+    drop_stale_locked(current_transition);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+/**
+ * @brief Marks the end of a profile transition and releases its broadcasts to the dispatcher.
+ * @note Broadcasts posted after this are never dropped as stale.
+ */
+void notify_end_transition(void) {
+    pthread_mutex_lock(&queue_mutex);
+    current_transition = 0;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+/**
+ * @brief Starts the broadcast dispatcher thread.
+ * @note Pending broadcasts are flushed on exit() through an atexit handler.
+ */
+void notify_dispatch_start(void) {
+    pthread_mutex_lock(&queue_mutex);
+    if (dispatcher_running) {
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+
+    if (pthread_create(&dispatcher_thread, NULL, dispatcher_worker, NULL) != 0) {
+        pthread_mutex_unlock(&queue_mutex);
+        log_zenith(LOG_ERROR, "Failed to spawn broadcast dispatcher thread");
+        return;
+    }
+    dispatcher_running = true;
+    dispatcher_stopping = false;
+    pthread_mutex_unlock(&queue_mutex);
+
+    atexit(notify_dispatch_stop);
+}
+
+/**
+ * @brief Delivers every queued broadcast and stops the dispatcher thread.
+ */
+void notify_dispatch_stop(void) {
+    pthread_mutex_lock(&queue_mutex);
+    if (!dispatcher_running || dispatcher_stopping) {
+        pthread_mutex_unlock(&queue_mutex);
+        return;
+    }
+    dispatcher_stopping = true;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+
+    pthread_join(dispatcher_thread, NULL);
+
+    pthread_mutex_lock(&queue_mutex);
+    dispatcher_running = false;
+    dispatcher_stopping = false;
+    pthread_mutex_unlock(&queue_mutex);
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <signal.h>
+#include <sys/socket.h>
+
+#define PROC_EVENTS_RECENT_SIZE 32
+
+/**
+ * @struct RecentProcess
+ * @brief An app process seen switching to its app UID, remembered for late game detection.
+ */
+typedef struct {
+    pid_t pid;
+    int uid;
+} RecentProcess;
+
+/*
+ * Zygote forks app processes and only then drops to the app UID, so the UID change is the first
+ * event that identifies the owning package. Keep the most recent ones so a game that started
+ * before it got focused can still be picked up without waiting for background_apps. Only filled
+ * while events are received, so this covers respawns and relaunches during a game session.
+ */
+static RecentProcess recent[PROC_EVENTS_RECENT_SIZE];
+static int recent_next = 0;
+
+/**
+ * @brief Asks the kernel to start or stop multicasting process events.
+ * @return 0 on success, -1 on failure.
+ */
+static int send_mcast_op(int fd, enum proc_cn_mcast_op op) {
+    char req[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))]
+        __attribute__((aligned(NLMSG_ALIGNTO))) = {0};
+    struct nlmsghdr* nlh = (struct nlmsghdr*)req;
+    struct cn_msg* cn = NLMSG_DATA(nlh);
+
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    nlh->nlmsg_type = NLMSG_DONE;
+    nlh->nlmsg_pid = getpid();
+    cn->id.idx = CN_IDX_PROC;
+    cn->id.val = CN_VAL_PROC;
+    cn->len = sizeof(op);
+    memcpy(cn->data, &op, sizeof(op));
+
+    return send(fd, req, nlh->nlmsg_len, 0) < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Subscribes to kernel process events over the netlink proc connector.
+ * @note Needs CONFIG_PROC_EVENTS and CAP_NET_ADMIN, callers fall back to background_apps otherwise.
+ * The socket starts out listening, see proc_events_set_active().
+ * @return Non-blocking netlink socket to add to the poll set, or -1 if unavailable.
+ */
+int proc_events_open(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_nl addr = {0};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = getpid();
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        log_zenith(LOG_WARN, "Proc connector unavailable (%s), tracking games via background_apps", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (send_mcast_op(fd, PROC_CN_MCAST_LISTEN) != 0) {
+        log_zenith(LOG_WARN, "Proc connector subscribe failed (%s), tracking games via background_apps",
+                   strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    log_zenith(LOG_INFO, "Listening for process events on proc connector");
+    return fd;
+}
+
+/**
+ * @brief Starts or stops receiving process events.
+ * @note Every fork, exec and exit of the system is an event, so they are only received while a
+ * game is launching or running. Stopping leaves the multicast group as well, other listeners
+ * keep the kernel sending but nothing is queued on this socket anymore.
+ * @param fd Socket returned by proc_events_open().
+ * @param active Set to true to receive events, false to stop.
+ */
+void proc_events_set_active(int fd, bool active) {
+    int group = CN_IDX_PROC;
+    if (active) {
+        setsockopt(fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group, sizeof(group));
+        send_mcast_op(fd, PROC_CN_MCAST_LISTEN);
+    } else {
+        send_mcast_op(fd, PROC_CN_MCAST_IGNORE);
+        setsockopt(fd, SOL_NETLINK, NETLINK_DROP_MEMBERSHIP, &group, sizeof(group));
+
+        /* Whatever is still queued is stale by the time events are wanted again */
+        char buf[4096];
+        while (recv(fd, buf, sizeof(buf), 0) > 0)
+            ;
+    }
+    log_verbose(LOG_DEBUG, "Process events %s", active ? "resumed" : "paused");
+}
+
+/**
+ * @brief Checks whether a process command line belongs to a package.
+ * @note Matches the main process name and its ":service" sub-processes.
+ * @param pid The process to inspect.
+ * @param package The target package name.
+ * @return true if the process runs the package.
+ */
+static bool cmdline_matches(pid_t pid, const char* package) {
+    char path[32];
+    char cmdline[MAX_PACKAGE + 64] = {0};
+
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    ssize_t n = read(fd, cmdline, sizeof(cmdline) - 1);
+    close(fd);
+    if (n <= 0)
+        return false;
+
+    size_t len = strlen(package);
+    return strncmp(cmdline, package, len) == 0 && (cmdline[len] == '\0' || cmdline[len] == ':');
+}
+
+/**
+ * @brief Looks up a PID in a tracked PID list.
+ * @return Index of the PID, or -1 if it is not tracked.
+ */
+static int find_pid(const pid_t* pids, int count, pid_t pid) {
+    for (int i = 0; i < count; i++) {
+        if (pids[i] == pid)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Drains pending process events and applies them to a game's tracked PID list.
+ * @note New processes are attributed to the game when they fork from a tracked PID, switch to the
+ * game UID, or exec the game package; exited processes are removed.
+ * @param fd Socket returned by proc_events_open().
+ * @param package Package of the current game, or NULL if no game is active.
+ * @param target_uid App UID of the current game, or -1 if unknown.
+ * @param pids Tracked PID list, updated in place.
+ * @param count Number of PIDs in the list.
+ * @param max_pids Maximum number of PIDs to track.
+ * @return The new PID count, or -1 if no event touched the list.
+ */
+int proc_events_handle(int fd, const char* package, int target_uid, pid_t* pids, int count, int max_pids) {
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    bool changed = false;
+    ssize_t len;
+
+    while ((len = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        for (struct nlmsghdr* nlh = (struct nlmsghdr*)buf; NLMSG_OK(nlh, (size_t)len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_NOOP)
+                continue;
+
+            struct cn_msg* cn = NLMSG_DATA(nlh);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC)
+                continue;
+
+            struct proc_event* ev = (struct proc_event*)cn->data;
+            pid_t pid = -1;
+            bool attribute = false;
+
+            switch (ev->what) {
+            case PROC_EVENT_FORK:
+                pid = ev->event_data.fork.child_pid;
+                if (pid != ev->event_data.fork.child_tgid)
+                    continue;
+                attribute = find_pid(pids, count, ev->event_data.fork.parent_tgid) >= 0;
+                break;
+            case PROC_EVENT_UID:
+                pid = ev->event_data.id.process_pid;
+                if (pid != ev->event_data.id.process_tgid || ev->event_data.id.e.euid < 10000)
+                    continue;
+                recent[recent_next] = (RecentProcess){pid, (int)ev->event_data.id.e.euid};
+                recent_next = (recent_next + 1) % PROC_EVENTS_RECENT_SIZE;
+                attribute = target_uid >= 0 && (int)ev->event_data.id.e.euid == target_uid;
+                break;
+            case PROC_EVENT_EXEC:
+                pid = ev->event_data.exec.process_pid;
+                if (pid != ev->event_data.exec.process_tgid)
+                    continue;
+                attribute = package && cmdline_matches(pid, package);
+                break;
+            case PROC_EVENT_EXIT:
+                pid = ev->event_data.exit.process_pid;
+                if (pid != ev->event_data.exit.process_tgid)
+                    continue;
+                for (int i = 0; i < PROC_EVENTS_RECENT_SIZE; i++) {
+                    if (recent[i].pid == pid)
+                        recent[i].pid = 0;
+                }
+                int idx = find_pid(pids, count, pid);
+                if (idx >= 0) {
+                    pids[idx] = pids[--count];
+                    changed = true;
+                }
+                continue;
+            default:
+                continue;
+            }
+
+            if (attribute && package && count < max_pids && find_pid(pids, count, pid) < 0) {
+                pids[count++] = pid;
+                changed = true;
+            }
+        }
+    }
+
+    if (len < 0 && errno == ENOBUFS) [[clang::unlikely]] {
+        log_zenith(LOG_WARN, "Proc connector overrun, some process events were lost");
+    }
+
+    return changed ? count : -1;
+}
+
+/**
+ * @brief Returns recently started app processes that still run under a UID.
+ * @param uid App UID of the game.
+ * @param pids Array to store the found PIDs, oldest first.
+ * @param max_pids Maximum number of PIDs the array can hold.
+ * @return Number of PIDs stored.
+ */
+int proc_events_find_recent(int uid, pid_t* pids, int max_pids) {
+    int count = 0;
+    if (uid < 0)
+        return 0;
+
+    for (int i = 0; i < PROC_EVENTS_RECENT_SIZE && count < max_pids; i++) {
+        RecentProcess* p = &recent[(recent_next + i) % PROC_EVENTS_RECENT_SIZE];
+        if (p->pid > 0 && p->uid == uid && kill(p->pid, 0) == 0)
+            pids[count++] = p->pid;
+    }
+    return count;
+}
@@ -17,8 +17,158 @@
 #include <AZenith.h>
 #include <sys/system_properties.h>
 
+#define BACKGROUND_APPS_FILE "/data/adb/.config/AZenith/background_apps"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+/**
+ * @struct ProcessEntry
+ * @brief One "package pid uid" line of the background apps cache.
+ */
+typedef struct {
+    char package[MAX_PACKAGE];
+    pid_t pid;
+    int uid;
+    int next_same_pkg;
+} ProcessEntry;
+
+/*
+ * Daemon-owned process table, rebuilt once per background_apps change. Package and PID lookups go
+ * through two open-addressing indexes whose slots hold entry index + 1 (0 marks an empty slot).
+ * Entries sharing a package are chained in file order. Only touched from the main thread.
+ */
+static ProcessEntry* proc_entries = NULL;
+static int proc_count = 0;
+static int proc_capacity = 0;
+static int* pkg_slots = NULL;
+static int* pid_slots = NULL;
+static size_t slot_mask = 0;
+static bool proc_table_loaded = false;
+
+/**
+ * @brief Multiplicative hash of a PID.
+ */
+static size_t hash_pid(pid_t pid) {
+    return (uint32_t)pid * 2654435761u;
+}
+
+/**
+ * @brief Grows the index slot arrays to fit the current entry count at a load factor <= 0.5.
+ * @return true on success, false on allocation failure.
+ */
+static bool size_index_slots(void) {
+    size_t slots = 64;
+    while (slots < (size_t)proc_count * 2)
+        slots <<= 1;
+
+    if (slots - 1 != slot_mask) {
+        int* new_pkg = realloc(pkg_slots, slots * sizeof(int));
+        if (!new_pkg)
+            return false;
+        pkg_slots = new_pkg;
+
+        int* new_pid = realloc(pid_slots, slots * sizeof(int));
+        if (!new_pid)
+            return false;
+        pid_slots = new_pid;
+
+        slot_mask = slots - 1;
+    }
+
+    memset(pkg_slots, 0, (slot_mask + 1) * sizeof(int));
+    memset(pid_slots, 0, (slot_mask + 1) * sizeof(int));
+    return true;
+}
+
+/**
+ * @brief Finds the package index slot for a name, either holding it or the empty slot to use.
+ */
+static size_t find_package_slot(const char* name) {
+    size_t i = fnv1a_hash(name) & slot_mask;
+    while (pkg_slots[i] && strcmp(proc_entries[pkg_slots[i] - 1].package, name) != 0)
+        i = (i + 1) & slot_mask;
+    return i;
+}
+
+/**
+ * @brief Finds the PID index slot for a PID, either holding it or the empty slot to use.
+ */
+static size_t find_pid_slot(pid_t pid) {
+    size_t i = hash_pid(pid) & slot_mask;
+    while (pid_slots[i] && proc_entries[pid_slots[i] - 1].pid != pid)
+        i = (i + 1) & slot_mask;
+    return i;
+}
+
+/**
+ * @brief Re-reads the background apps cache once and rebuilds the package and PID indexes.
+ * @note Call on every background_apps change; lookups in between never touch the file.
+ * @return Number of processes in the table, or -1 if the file could not be read.
+ */
+int rebuild_process_table(void) {
+    proc_table_loaded = true;
+    proc_count = 0;
+
+    FILE* fp = fopen(BACKGROUND_APPS_FILE, "r");
+    if (!fp) {
+        size_index_slots();
+        return -1;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        ProcessEntry entry;
+        if (sscanf(line, "%127s %d %d", entry.package, &entry.pid, &entry.uid) != 3)
+            continue;
+
+        if (proc_count >= proc_capacity) {
+            int new_capacity = proc_capacity ? proc_capacity * 2 : 64;
+            ProcessEntry* grown = realloc(proc_entries, new_capacity * sizeof(ProcessEntry));
+            if (!grown) {
+                log_zenith(LOG_ERROR, "OOM: Failed to grow process table");
+                break;
+            }
+            proc_entries = grown;
+            proc_capacity = new_capacity;
+        }
+
+        entry.next_same_pkg = -1;
+        proc_entries[proc_count++] = entry;
+    }
+    fclose(fp);
+
+    if (!size_index_slots()) {
+        log_zenith(LOG_ERROR, "OOM: Failed to size process table index");
+        proc_count = 0;
+        return -1;
+    }
+
+    /* Insert back to front so package chains end up in file order and the first PID line wins */
+    for (int i = proc_count - 1; i >= 0; i--) {
+        size_t ps = find_package_slot(proc_entries[i].package);
+        proc_entries[i].next_same_pkg = pkg_slots[ps] ? pkg_slots[ps] - 1 : -1;
+        pkg_slots[ps] = i + 1;
+
+        pid_slots[find_pid_slot(proc_entries[i].pid)] = i + 1;
+    }
+
+    return proc_count;
+}
+
+/**
+ * @brief Returns how many processes the current process table holds.
+ * @return Entry count, building the table first if it was never loaded.
+ */
+int process_table_size(void) {
+    if (!proc_table_loaded)
+        rebuild_process_table();
+    return proc_count;
+}
+
 /**
- * @brief Retrieves all PIDs associated with a specific package name from the background apps cache.
+ * @brief Retrieves all PIDs associated with a specific package name from the process table.
  * @param name The target package name.
  * @param pids Array to store the found PIDs.
  * @param max_pids Maximum number of PIDs the array can hold.
@@ -28,32 +178,21 @@ int get_pids_of(const char* name, pid_t* pids, int max_pids) {
     if (!name || !name[0] || max_pids < 1)
         return 0;
 
-    FILE* fp = fopen("/data/adb/.config/AZenith/background_apps", "r");
-    if (!fp)
+    if (!proc_table_loaded)
+        rebuild_process_table();
+    if (proc_count == 0)
         return 0;
 
-    char line[256];
     int count = 0;
+    int slot = pkg_slots[find_package_slot(name)];
+    for (int i = slot - 1; slot && i >= 0 && count < max_pids; i = proc_entries[i].next_same_pkg)
+        pids[count++] = proc_entries[i].pid;
 
-    while (fgets(line, sizeof(line), fp) && count < max_pids) {
-        char pkg[128];
-        pid_t pid;
-        int uid;
-
-        if (sscanf(line, "%127s %d %d", pkg, &pid, &uid) == 3) {
-            if (strcmp(pkg, name) == 0) {
-                pids[count] = pid;
-                count++;
-            }
-        }
-    }
-
-    fclose(fp);
     return count;
 }
 
 /**
- * @brief Fetches the UID of a process from the background apps cache using its PID.
+ * @brief Fetches the UID of a process from the process table using its PID.
  * @param pid The PID of the process.
  * @return The UID of the process, or -1 on error/not found.
  */
@@ -61,26 +200,13 @@ int uidof(pid_t pid) {
     if (pid <= 0)
         return -1;
 
-    FILE* fp = fopen("/data/adb/.config/AZenith/background_apps", "r");
-    if (!fp)
+    if (!proc_table_loaded)
+        rebuild_process_table();
+    if (proc_count == 0)
         return -1;
 
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        char pkg[128];
-        pid_t current_pid;
-        int current_uid;
-
-        if (sscanf(line, "%127s %d %d", pkg, &current_pid, &current_uid) == 3) {
-            if (current_pid == pid) {
-                fclose(fp);
-                return current_uid;
-            }
-        }
-    }
-
-    fclose(fp);
-    return -1;
+    int slot = pid_slots[find_pid_slot(pid)];
+    return slot ? proc_entries[slot - 1].uid : -1;
 }
 
 /**
@@ -94,3 +220,19 @@ void set_priority(const pid_t pid) {
     if (syscall(SYS_ioprio_set, 1, pid, (1 << 13) | 0) == -1)
         log_zenith(LOG_ERROR, "Unable to set IO priority for %d", pid);
 }
+
+/**
+ * @brief Opens a pidfd that becomes readable when the process exits.
+ * @note The pidfd keeps referring to the same process even if its PID is recycled.
+ * @param pid The PID of the process.
+ * @return The pidfd, or -1 if the process is gone or the kernel lacks pidfd_open (< 5.3).
+ */
+int pidfd_of(pid_t pid) {
+    if (pid <= 0)
+        return -1;
+
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (fd >= 0)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
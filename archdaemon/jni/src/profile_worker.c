@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <poll.h>
+#include <signal.h>
+
+#define PROFILE_WORKER_DONE "__AZPW_DONE "
+#define PROFILE_WORKER_LINE 1024
+
+/**
+ * @struct ProfileWorker
+ * @brief The resident "sys.azenith-profilesettings worker" process and its command pipes.
+ * @note The worker keeps the cpufreq tables it discovered between commands, so an apply costs one
+ * line over the pipe plus the sysfs writes instead of a shell, an exec and a fresh discovery.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pid_t pid;
+    int in_fd;
+    int out_fd;
+    char line[PROFILE_WORKER_LINE];
+    size_t line_len;
+} ProfileWorker;
+
+static ProfileWorker worker = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .pid = -1,
+    .in_fd = -1,
+    .out_fd = -1,
+};
+
+static bool worker_disabled = false;
+
+/**
+ * @brief Closes the worker pipes and reaps the worker process.
+ * @note Caller must hold worker.lock.
+ * @param force Set to true to SIGKILL the worker group instead of letting it exit on stdin EOF.
+ * @return The exit status of the worker, or -1 if it did not exit normally.
+ */
+static int reap_worker(bool force) {
+    int status = -1;
+
+    if (worker.in_fd >= 0)
+        close(worker.in_fd);
+    if (worker.out_fd >= 0)
+        close(worker.out_fd);
+    if (worker.pid > 0) {
+        if (force)
+            kill(-worker.pid, SIGKILL);
+        if (waitpid(worker.pid, &status, 0) == -1 || !WIFEXITED(status))
+            status = -1;
+        else
+            status = WEXITSTATUS(status);
+    }
+    worker.in_fd = -1;
+    worker.out_fd = -1;
+    worker.pid = -1;
+    worker.line_len = 0;
+    return status;
+}
+
+/**
+ * @brief Starts a fresh worker process.
+ * @note Caller must hold worker.lock. The binary is resolved through MY_PATH by sh, exactly like
+ * the systemv() calls this replaces.
+ * @return true if the worker process was started.
+ */
+static bool spawn_worker(void) {
+    int in_pipe[2], out_pipe[2];
+
+    if (pipe2(in_pipe, O_CLOEXEC) == -1)
+        return false;
+    if (pipe2(out_pipe, O_CLOEXEC) == -1) {
+        close(in_pipe[0]);
+        close(in_pipe[1]);
+        return false;
+    }
+
+    char* argv[] = {"sh", "-c", "exec sys.azenith-profilesettings worker", NULL};
+    char* env[] = {MY_PATH, NULL};
+    int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    pid_t pid = exec_spawn("/system/bin/sh", argv, env, (const int[3]){in_pipe[0], out_pipe[1], devnull});
+    if (devnull >= 0)
+        close(devnull);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    if (pid == -1) [[clang::unlikely]] {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return false;
+    }
+
+    worker.pid = pid;
+    worker.in_fd = in_pipe[1];
+    worker.out_fd = out_pipe[0];
+    worker.line_len = 0;
+    return true;
+}
+
+/**
+ * @brief Takes the next complete line out of the worker's read buffer.
+ * @note Caller must hold worker.lock. Lines longer than the buffer are cut, they can only be noise
+ * from a child process and never the status line.
+ * @return The status carried by a PROFILE_WORKER_DONE line, -1 for any other line, or -2 if no
+ * complete line is buffered yet.
+ */
+static int take_line(void) {
+    char* nl = memchr(worker.line, '\n', worker.line_len);
+    if (!nl) {
+        if (worker.line_len == sizeof(worker.line))
+            worker.line_len = 0;
+        return -2;
+    }
+
+    *nl = '\0';
+    int status = -1;
+    if (strncmp(worker.line, PROFILE_WORKER_DONE, sizeof(PROFILE_WORKER_DONE) - 1) == 0)
+        status = atoi(worker.line + sizeof(PROFILE_WORKER_DONE) - 1);
+
+    size_t consumed = nl - worker.line + 1;
+    worker.line_len -= consumed;
+    memmove(worker.line, nl + 1, worker.line_len);
+    return status;
+}
+
+/**
+ * @brief Sends one command to the worker and waits for its status line.
+ * @note Caller must hold worker.lock.
+ * @param command Profile settings command, e.g. "2" or "applyfreqbalance".
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @return The status of the command. If the worker died instead of answering, its exit status is
+ * returned and a new worker is started on next use. If the deadline passes, the worker and
+ * everything it started are killed and EXEC_TIMED_OUT is returned.
+ */
+static int worker_exec(const char* command, int timeout_ms) {
+    char request[MAX_COMMAND_LENGTH];
+    int request_len = snprintf(request, sizeof(request), "%s\n", command);
+    if (request_len <= 0 || request_len >= (int)sizeof(request))
+        return -1;
+
+    ssize_t sent = 0;
+    while (sent < request_len) {
+        ssize_t n = write(worker.in_fd, request + sent, request_len - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) [[clang::unlikely]]
+            return reap_worker(true);
+        sent += n;
+    }
+
+    uint64_t deadline = timeout_ms >= 0 ? exec_clock_ns() + (uint64_t)timeout_ms * 1000000ULL : 0;
+    for (;;) {
+        int status;
+        while ((status = take_line()) == -1)
+            ;
+        if (status != -2)
+            return status;
+
+        if (deadline) {
+            uint64_t now = exec_clock_ns();
+            struct pollfd pfd = {.fd = worker.out_fd, .events = POLLIN};
+            int ready = now >= deadline ? 0 : poll(&pfd, 1, (int)((deadline - now + 999999) / 1000000));
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready == 0) {
+                /* The worker leads its own process group, a hung sysfs write or child goes with it */
+                reap_worker(true);
+                log_zenith(LOG_WARN, "Profile worker timed out after %d ms and was killed: %s", timeout_ms, command);
+                return EXEC_TIMED_OUT;
+            }
+        }
+
+        ssize_t n = read(worker.out_fd, worker.line + worker.line_len, sizeof(worker.line) - worker.line_len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) [[clang::unlikely]]
+            return reap_worker(false);
+        worker.line_len += n;
+    }
+}
+
+/**
+ * @brief Runs a sys.azenith-profilesettings command, preferring the resident worker.
+ * @note Falls back to a one-shot systemv() when the worker cannot be started, and for the rest of
+ * the daemon's life once the installed binary turns out to lack the worker mode.
+ * @param command Profile settings command, e.g. "2" or "applyfreqbalance".
+ * @return The exit status of the command, -1 on failure, or EXEC_TIMED_OUT if it hung and was killed.
+ */
+int run_profilesettings(const char* command) {
+    char what[MAX_COMMAND_LENGTH];
+    snprintf(what, sizeof(what), "sys.azenith-profilesettings %s", command);
+
+    pthread_mutex_lock(&worker.lock);
+    if (worker_disabled) {
+        pthread_mutex_unlock(&worker.lock);
+        return systemv("%s", what);
+    }
+
+    uint64_t start = exec_clock_ns();
+    bool fresh = worker.pid <= 0;
+    if (fresh && !spawn_worker()) [[clang::unlikely]] {
+        pthread_mutex_unlock(&worker.lock);
+        return systemv("%s", what);
+    }
+
+    uint64_t spawned = exec_clock_ns();
+    int status = worker_exec(command, EXEC_TIMEOUT_MS);
+
+    /* An older binary ignores "worker" and exits cleanly without answering its first command */
+    bool unsupported = fresh && worker.pid <= 0 && status >= 0;
+    if (unsupported)
+        worker_disabled = true;
+    pthread_mutex_unlock(&worker.lock);
+
+    if (unsupported) [[clang::unlikely]] {
+        log_zenith(LOG_WARN, "Profile worker unavailable (exit %d), running profile settings per call", status);
+        return systemv("%s", what);
+    }
+
+    exec_stats_record(what, EXEC_WORKER, spawned - start, exec_clock_ns() - spawned, status != 0);
+    return status;
+}
+
+/**
+ * @brief Stops the resident worker, letting it finish on stdin EOF.
+ */
+void profile_worker_shutdown(void) {
+    pthread_mutex_lock(&worker.lock);
+    reap_worker(false);
+    pthread_mutex_unlock(&worker.lock);
+}
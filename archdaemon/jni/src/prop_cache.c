@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <dlfcn.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+
+/**
+ * @struct PropEntry
+ * @brief Cached value of one system property, refreshed only when its serial changes.
+ */
+typedef struct {
+    const char* name;
+    const prop_info* pi;
+    uint32_t serial;
+    uint32_t area_serial;
+    bool loaded;
+    char value[PROP_VALUE_MAX];
+} PropEntry;
+
+static PropEntry entries[PROP_COUNT] = {
+    [PROP_DEBUGMODE] = {.name = "persist.sys.azenith.debugmode"},
+    [PROP_IOSCHED] = {.name = "persist.sys.azenithconf.iosched"},
+    [PROP_CPULIMIT] = {.name = "persist.sys.azenithconf.cpulimit"},
+    [PROP_DND] = {.name = "persist.sys.azenithconf.dnd"},
+    [PROP_APRELOAD] = {.name = "persist.sys.azenithconf.APreload"},
+    [PROP_PRELOADBUDGET] = {.name = "persist.sys.azenithconf.preloadbudget"},
+    [PROP_SHOWTOAST] = {.name = "persist.sys.azenithconf.showtoast"},
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t resolve_once = PTHREAD_ONCE_INIT;
+static atomic_uint pending_changes = 0;
+static int change_fd = -1;
+
+/*
+ * Serial and wait helpers are only declared by the NDK headers from API 26 while we target 24,
+ * so resolve them from libc at runtime. Without them every read goes to __system_property_get.
+ */
+static uint32_t (*prop_serial)(const prop_info* pi);
+static uint32_t (*prop_area_serial)(void);
+static bool (*prop_wait)(const prop_info* pi, uint32_t old_serial, uint32_t* new_serial,
+                         const struct timespec* timeout);
+
+/**
+ * @brief Looks up a libc symbol into a function pointer.
+ * @note Goes through memcpy since ISO C has no conversion from object to function pointers.
+ */
+static void resolve_symbol(void* fn_ptr, const char* name) {
+    void* sym = dlsym(RTLD_DEFAULT, name);
+    memcpy(fn_ptr, &sym, sizeof(sym));
+}
+
+static void resolve_property_api(void) {
+    resolve_symbol(&prop_serial, "__system_property_serial");
+    resolve_symbol(&prop_area_serial, "__system_property_area_serial");
+    resolve_symbol(&prop_wait, "__system_property_wait");
+}
+
+/**
+ * @brief Brings a cache entry up to date with the property area.
+ * @note Caller must hold cache_mutex. A property that does not exist yet is looked up again only
+ * after the global area serial moved.
+ * @return true if a previously loaded value changed.
+ */
+static bool refresh_entry(PropEntry* e) {
+    if (!e->pi) {
+        if (prop_area_serial) {
+            uint32_t area = prop_area_serial();
+            if (e->loaded && area == e->area_serial)
+                return false;
+            e->area_serial = area;
+        }
+
+        e->pi = __system_property_find(e->name);
+        if (!e->pi) {
+            bool changed = e->loaded && e->value[0] != '\0';
+            e->value[0] = '\0';
+            e->loaded = true;
+            return changed;
+        }
+    }
+
+    uint32_t serial = prop_serial(e->pi);
+    if (e->loaded && serial == e->serial)
+        return false;
+
+    char value[PROP_VALUE_MAX] = {0};
+    __system_property_get(e->name, value);
+    bool changed = e->loaded && strcmp(value, e->value) != 0;
+    memcpy(e->value, value, sizeof(value));
+    e->serial = serial;
+    e->loaded = true;
+    return changed;
+}
+
+/**
+ * @brief Reads a cached system property.
+ * @note Costs a serial comparison when the property did not change since the last read.
+ * @param id Property to read.
+ * @param value Destination buffer of PROP_VALUE_MAX bytes.
+ * @return Length of the value, 0 if the property is unset.
+ */
+int prop_cache_get(CachedProp id, char* value) {
+    pthread_once(&resolve_once, resolve_property_api);
+    if (!prop_serial) [[clang::unlikely]]
+        return __system_property_get(entries[id].name, value);
+
+    pthread_mutex_lock(&cache_mutex);
+    PropEntry* e = &entries[id];
+    if (refresh_entry(e))
+        atomic_fetch_or(&pending_changes, 1u << id);
+    memcpy(value, e->value, PROP_VALUE_MAX);
+    pthread_mutex_unlock(&cache_mutex);
+    return strlen(value);
+}
+
+/**
+ * @brief Compares a cached system property against a value.
+ * @return true if the property is set to exactly that value.
+ */
+bool prop_cache_equals(CachedProp id, const char* expected) {
+    char value[PROP_VALUE_MAX];
+    prop_cache_get(id, value);
+    return strcmp(value, expected) == 0;
+}
+
+/**
+ * @brief Returns the name of a cached property for logging.
+ */
+const char* prop_cache_name(CachedProp id) {
+    return entries[id].name;
+}
+
+/**
+ * @brief Watcher thread: sleeps in __system_property_wait and refreshes the cache on every
+ * property area change, ringing change_fd when a cached value differs.
+ */
+static void* prop_watcher(void* arg) {
+    (void)arg;
+    pthread_setname_np(pthread_self(), "AZenithProps");
+
+    for (;;) {
+        /* Sample the area serial before refreshing so a change made meanwhile still wakes us */
+        uint32_t area = prop_area_serial();
+        uint32_t changed = 0;
+
+        pthread_mutex_lock(&cache_mutex);
+        for (int i = 0; i < PROP_COUNT; i++) {
+            if (refresh_entry(&entries[i]))
+                changed |= 1u << i;
+        }
+        pthread_mutex_unlock(&cache_mutex);
+
+        if (changed || atomic_load(&pending_changes)) {
+            atomic_fetch_or(&pending_changes, changed);
+            uint64_t one = 1;
+            ssize_t ret = write(change_fd, &one, sizeof(one));
+            (void)ret;
+        }
+
+        uint32_t new_area;
+        prop_wait(NULL, area, &new_area, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Starts watching the cached properties so configuration changes reach the main loop
+ * as events.
+ * @return Descriptor to add to the poll set, readable after a cached property changed, or -1 if
+ * the platform lacks __system_property_wait.
+ */
+int prop_cache_watch_start(void) {
+    pthread_once(&resolve_once, resolve_property_api);
+    if (!prop_serial || !prop_area_serial || !prop_wait) {
+        log_zenith(LOG_WARN, "Property wait unavailable, config changes are picked up on next use");
+        return -1;
+    }
+
+    change_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (change_fd < 0)
+        return -1;
+
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGTERM);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&thread, &attr, prop_watcher, NULL);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (ret != 0) {
+        log_zenith(LOG_WARN, "Failed to spawn property watcher thread");
+        close(change_fd);
+        change_fd = -1;
+        return -1;
+    }
+    return change_fd;
+}
+
+/**
+ * @brief Collects the cached properties that changed since the previous call.
+ * @param fd Descriptor returned by prop_cache_watch_start().
+ * @return Bitmask of changed CachedProp values.
+ */
+uint32_t prop_cache_take_changes(int fd) {
+    uint64_t value;
+    ssize_t ret = read(fd, &value, sizeof(value));
+    (void)ret;
+    return atomic_exchange(&pending_changes, 0);
+}
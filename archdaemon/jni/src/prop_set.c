@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <stdatomic.h>
+
+/* Every call stands in for one setprop spawn, read around transitions by prop_set_count() */
+static atomic_uint prop_sets = 0;
+
+/**
+ * @brief Sets a system property through property_service without spawning setprop.
+ * @note Values the property already holds are skipped, persist properties are not rewritten.
+ * @param name Property name.
+ * @param value New value, may be empty.
+ * @return 0 on success or when unchanged, -1 if the property could not be set.
+ */
+int prop_set(const char* name, const char* value) {
+    if (strlen(value) >= PROP_VALUE_MAX) [[clang::unlikely]] {
+        log_zenith(LOG_ERROR, "Value of property %s is too long", name);
+        return -1;
+    }
+    atomic_fetch_add_explicit(&prop_sets, 1, memory_order_relaxed);
+
+    char current[PROP_VALUE_MAX] = {0};
+    __system_property_get(name, current);
+    if (strcmp(current, value) == 0)
+        return 0;
+
+    if (__system_property_set(name, value) != 0) [[clang::unlikely]] {
+        log_zenith(LOG_WARN, "Failed to set %s to [%s]", name, value);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns how many properties prop_set() handled since startup.
+ * @note Callers take the difference around a transition, each one replaced a setprop spawn.
+ */
+uint32_t prop_set_count(void) {
+    return atomic_load_explicit(&prop_sets, memory_order_relaxed);
+}
@@ -19,10 +19,14 @@
 #include <time.h>
 
 /**
- * @brief Retrieves the current screen refresh rate from the app monitor file.
+ * @brief Retrieves the current screen refresh rate from the shared app state or app monitor file.
  * @return The current refresh rate in Hz, or -1 if the file cannot be read.
  */
 int get_current_refresh_rate(void) {
+    int shared_rr;
+    if (app_state_read_refresh_rates(&shared_rr, NULL))
+        return shared_rr;
+
     FILE* fp = fopen(APP_MONITOR_FILE, "r");
     if (!fp) {
         return -1;
@@ -44,10 +48,15 @@ int get_current_refresh_rate(void) {
 }
 
 /**
- * @brief Detects the maximum supported hardware refresh rate from the app monitor file.
+ * @brief Detects the maximum supported hardware refresh rate from the shared app state or app
+ * monitor file.
  * @return The maximum refresh rate in Hz, defaulting to 60Hz if undetected or on error.
  */
 int get_max_refresh_rate(void) {
+    int shared_max;
+    if (app_state_read_refresh_rates(NULL, &shared_max))
+        return shared_max > 0 ? shared_max : 60;
+
     FILE* fp = fopen(APP_MONITOR_FILE, "r");
     if (!fp) {
         log_zenith(LOG_WARN, "App monitor file not found, defaulting max refresh rate to 60Hz");
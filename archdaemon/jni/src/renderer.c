@@ -19,14 +19,14 @@
 #include <time.h>
 
 /**
- * @brief Checks the current HWUI renderer and switches it to the target type if needed, then
- * restarts the app.
+ * @brief Checks the current HWUI renderer and switches it to the target type if needed.
+ * @note The app only picks up the new renderer once restart_app() ran, the caller schedules that
+ * after RENDERER_RESTART_DELAY_MS.
  * @param target_type The desired renderer type (e.g., "skiagl", "vulkan").
- * @param pkg The target package name to restart after switching.
  * @param saved_ref Buffer to store the original/previous renderer state.
- * @return true if the renderer was changed and the app was restarted, false otherwise.
+ * @return true if the renderer was changed and the app needs a restart, false otherwise.
  */
-bool apply_smart_renderer(const char* target_type, const char* pkg, char* saved_ref) {
+bool apply_smart_renderer(const char* target_type, char* saved_ref) {
     if (target_type == NULL || strcmp(target_type, "default") == 0 || strlen(target_type) == 0)
         return false;
 
@@ -46,14 +46,17 @@ bool apply_smart_renderer(const char* target_type, const char* pkg, char* saved_
                    current_renderer, target_type);
 
         systemv("sys.azenith-utilityconf setrender %s", target_type);
-
-        usleep(200000);
-
-        systemv("am force-stop %s && am start -n $(cmd package resolve-activity --brief %s | tail "
-                "-n 1)",
-                pkg, pkg);
-
         return true;
     }
     return false;
 }
+
+/**
+ * @brief Force-stops an app and launches its main activity again.
+ * @param pkg The target package name.
+ */
+void restart_app(const char* pkg) {
+    systemv("am force-stop %s && am start -n $(cmd package resolve-activity --brief %s | tail "
+            "-n 1)",
+            pkg, pkg);
+}
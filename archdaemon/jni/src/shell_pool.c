@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdatomic.h>
+
+#define SHELL_POOL_MARKER "__AZSP"
+#define SHELL_POOL_READ_CHUNK 512
+
+/**
+ * @struct ShellWorker
+ * @brief A long-lived /system/bin/sh coprocess that runs commands sent over its stdin pipe.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pid_t pid;
+    int in_fd;
+    int out_fd;
+    unsigned int seq;
+} ShellWorker;
+
+static ShellWorker pool[SHELL_POOL_MAX_WORKERS];
+static int pool_size = 0;
+
+static atomic_ullong stat_pooled_calls = 0;
+static atomic_ullong stat_fallback_calls = 0;
+static atomic_ullong stat_respawns = 0;
+static atomic_ullong stat_timeouts = 0;
+static atomic_ullong stat_saved_ns = 0;
+static atomic_ullong spawn_cost_ns = 0;
+static atomic_ullong saved_per_call_ns = 0;
+
+/**
+ * @brief Returns the monotonic clock in nanoseconds.
+ */
+static unsigned long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Closes the worker pipes and reaps the shell process.
+ * @param w Pointer to the worker, must be held locked by the caller.
+ * @param force Set to true to SIGKILL the shell instead of letting it exit on stdin EOF.
+ * @return The exit status of the shell, or -1 if it did not exit normally.
+ */
+static int reap_worker(ShellWorker* w, bool force) {
+    int status = -1;
+
+    if (w->in_fd >= 0)
+        close(w->in_fd);
+    if (w->out_fd >= 0)
+        close(w->out_fd);
+    if (w->pid > 0) {
+        if (force)
+            kill(w->pid, SIGKILL);
+        if (waitpid(w->pid, &status, 0) == -1 || !WIFEXITED(status))
+            status = -1;
+        else
+            status = WEXITSTATUS(status);
+    }
+    w->in_fd = -1;
+    w->out_fd = -1;
+    w->pid = -1;
+    return status;
+}
+
+/**
+ * @brief Wraps a command so it runs isolated inside the worker and reports its status.
+ * @note The command goes to eval as one single-quoted word inside a subshell: unbalanced quotes
+ * end as a syntax error of that command instead of swallowing the marker, and cd, set, variables
+ * or traps do not leak into the next command.
+ * @return Length of the script, or -1 if it does not fit.
+ */
+static int build_script(char* script, size_t size, const char* command, unsigned int seq) {
+    int len = snprintf(script, size, "( eval '");
+    if (len <= 0 || (size_t)len >= size)
+        return -1;
+
+    for (const char* c = command; *c; c++) {
+        /* A quote closes the word, goes in escaped and reopens it: '\'' */
+        if (*c == '\'') {
+            if ((size_t)len + 4 >= size)
+                return -1;
+            memcpy(script + len, "'\\''", 4);
+            len += 4;
+        } else {
+            if ((size_t)len + 1 >= size)
+                return -1;
+            script[len++] = *c;
+        }
+    }
+
+    /* Detach stdin, the worker's own stdin carries the next commands */
+    int tail = snprintf(script + len, size - len, "' ) </dev/null\necho \"%s%u:$?\"\n", SHELL_POOL_MARKER, seq);
+    if (tail <= 0 || (size_t)tail >= size - len)
+        return -1;
+    return len + tail;
+}
+
+/**
+ * @brief Sends one command to a worker and waits for its completion marker.
+ * @param w Pointer to the worker, must be held locked by the caller.
+ * @param command Shell command to run inside the worker.
+ * @param output Receives the complete stdout as a malloc'd string the caller frees, or NULL to discard it.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @return The exit status of the command. If the worker died anyway, its exit status is returned
+ * and it is respawned on next use. If the deadline passes, the worker and everything it started
+ * are killed and EXEC_TIMED_OUT is returned.
+ */
+static int worker_exec(ShellWorker* w, const char* command, char** output, int timeout_ms) {
+    char script[MAX_COMMAND_LENGTH * 4 + 64];
+    char marker[32];
+    unsigned int seq = ++w->seq;
+
+    int script_len = build_script(script, sizeof(script), command, seq);
+    if (script_len < 0)
+        return -1;
+
+    int marker_len = snprintf(marker, sizeof(marker), "%s%u:", SHELL_POOL_MARKER, seq);
+
+    ssize_t sent = 0;
+    while (sent < script_len) {
+        ssize_t n = write(w->in_fd, script + sent, script_len - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) [[clang::unlikely]] {
+            reap_worker(w, true);
+            return -1;
+        }
+        sent += n;
+    }
+
+    size_t cap = SHELL_POOL_READ_CHUNK;
+    size_t len = 0;
+    char* buf = malloc(cap);
+    if (!buf) [[clang::unlikely]] {
+        reap_worker(w, true);
+        return -1;
+    }
+
+    unsigned long long deadline = timeout_ms >= 0 ? now_ns() + (unsigned long long)timeout_ms * 1000000ULL : 0;
+    char* found = NULL;
+    size_t scan = 0;
+    while (!found) {
+        if (deadline) {
+            unsigned long long now = now_ns();
+            struct pollfd pfd = {.fd = w->out_fd, .events = POLLIN};
+            int ready = now >= deadline ? 0 : poll(&pfd, 1, (int)((deadline - now + 999999) / 1000000));
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready == 0) {
+                /* The worker leads its own process group, take the wedged command down with it */
+                free(buf);
+                kill(-w->pid, SIGKILL);
+                reap_worker(w, true);
+                atomic_fetch_add(&stat_timeouts, 1);
+                log_zenith(LOG_WARN, "Command timed out after %d ms and was killed: %s", timeout_ms, command);
+                return EXEC_TIMED_OUT;
+            }
+        }
+
+        if (cap - len < SHELL_POOL_READ_CHUNK) {
+            char* grown = realloc(buf, cap * 2);
+            if (!grown) [[clang::unlikely]] {
+                free(buf);
+                reap_worker(w, true);
+                return -1;
+            }
+            buf = grown;
+            cap *= 2;
+        }
+
+        ssize_t n = read(w->out_fd, buf + len, cap - len - 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) [[clang::unlikely]] {
+            /* The worker itself died, commands only run in subshells of it */
+            free(buf);
+            return reap_worker(w, false);
+        }
+        len += n;
+        buf[len] = '\0';
+
+        /* Output is not capped, only rescan from where a marker could still start */
+        char* m = strstr(buf + scan, marker);
+        if (m && strchr(m + marker_len, '\n'))
+            found = m;
+        else
+            scan = m ? (size_t)(m - buf) : len > (size_t)marker_len ? len - marker_len : 0;
+    }
+
+    int status = atoi(found + marker_len);
+
+    if (output) {
+        *found = '\0';
+        *output = buf;
+    } else {
+        free(buf);
+    }
+    return status;
+}
+
+/**
+ * @brief Forks a fresh shell worker and performs the startup handshake.
+ * @param w Pointer to the worker, must be held locked by the caller.
+ * @return true if the worker is ready to accept commands, false otherwise.
+ */
+static bool spawn_worker(ShellWorker* w) {
+    int in_pipe[2], out_pipe[2];
+    unsigned long long start = now_ns();
+
+    if (pipe2(in_pipe, O_CLOEXEC) == -1)
+        return false;
+    if (pipe2(out_pipe, O_CLOEXEC) == -1) {
+        close(in_pipe[0]);
+        close(in_pipe[1]);
+        return false;
+    }
+
+    char* argv[] = {"sh", NULL};
+    char* env[] = {MY_PATH, NULL};
+    int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    pid_t pid = exec_spawn("/system/bin/sh", argv, env, (const int[3]){in_pipe[0], out_pipe[1], devnull});
+    if (devnull >= 0)
+        close(devnull);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    if (pid == -1) [[clang::unlikely]] {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return false;
+    }
+
+    w->pid = pid;
+    w->in_fd = in_pipe[1];
+    w->out_fd = out_pipe[0];
+    w->seq = 0;
+
+    if (worker_exec(w, "true", NULL, EXEC_TIMEOUT_MS) != 0)
+        return false;
+
+    /* A spawn-per-call systemv() pays this spawn + exec + shell startup on every command */
+    unsigned long long spawned = now_ns();
+    atomic_store(&spawn_cost_ns, spawned - start);
+
+    /* The pool pays the write, the subshell fork and the marker instead, measured on the warm worker */
+    if (worker_exec(w, "true", NULL, EXEC_TIMEOUT_MS) != 0)
+        return false;
+    unsigned long long round_trip = now_ns() - spawned;
+    atomic_store(&saved_per_call_ns, spawned - start > round_trip ? spawned - start - round_trip : 0);
+    return true;
+}
+
+/**
+ * @brief Checks whether a command must not run inside a persistent worker.
+ * @note Backgrounded commands would keep writing into the worker's stdout pipe.
+ * @param command Shell command string.
+ * @return true if the command has to take the fork path.
+ */
+static bool needs_own_process(const char* command) {
+    size_t len = strlen(command);
+    while (len > 0 && isspace((unsigned char)command[len - 1]))
+        len--;
+
+    return len > 0 && command[len - 1] == '&' && (len < 2 || command[len - 2] != '&');
+}
+
+/**
+ * @brief Starts the persistent shell worker pool.
+ * @note Must be called after daemon() so the workers belong to the daemonized process.
+ * @param size Number of workers to start, capped at SHELL_POOL_MAX_WORKERS.
+ * @return Number of workers that came up successfully.
+ */
+int shell_pool_init(int size) {
+    if (size > SHELL_POOL_MAX_WORKERS)
+        size = SHELL_POOL_MAX_WORKERS;
+
+    /* A dead worker must surface as EPIPE, not kill the daemon */
+    signal(SIGPIPE, SIG_IGN);
+
+    int ready = 0;
+    for (int i = 0; i < size; i++) {
+        ShellWorker* w = &pool[i];
+        pthread_mutex_init(&w->lock, NULL);
+        w->pid = -1;
+        w->in_fd = -1;
+        w->out_fd = -1;
+
+        pthread_mutex_lock(&w->lock);
+        if (spawn_worker(w)) {
+            ready++;
+        } else {
+            reap_worker(w, true);
+        }
+        pthread_mutex_unlock(&w->lock);
+    }
+
+    pool_size = size;
+    log_zenith(LOG_INFO, "Shell pool started with %d/%d workers (spawn cost %.2f ms)", ready, size,
+               atomic_load(&spawn_cost_ns) / 1e6);
+    return ready;
+}
+
+/**
+ * @brief Runs a shell command on an idle pool worker.
+ * @param command Fully formatted shell command.
+ * @param output Receives the complete stdout as a malloc'd string the caller frees, or NULL to discard it.
+ * @param timeout_ms Deadline in milliseconds, or -1 to wait indefinitely.
+ * @return The exit status of the command, -1 if the worker failed, EXEC_TIMED_OUT, or
+ * SHELL_POOL_UNAVAILABLE when the caller should fall back to forking its own shell.
+ */
+int shell_pool_run(const char* command, char** output, int timeout_ms) {
+    if (pool_size == 0 || needs_own_process(command)) {
+        atomic_fetch_add(&stat_fallback_calls, 1);
+        return SHELL_POOL_UNAVAILABLE;
+    }
+
+    for (int i = 0; i < pool_size; i++) {
+        ShellWorker* w = &pool[i];
+        if (pthread_mutex_trylock(&w->lock) != 0)
+            continue;
+
+        if (w->pid <= 0) {
+            atomic_fetch_add(&stat_respawns, 1);
+            if (!spawn_worker(w)) [[clang::unlikely]] {
+                reap_worker(w, true);
+                pthread_mutex_unlock(&w->lock);
+                continue;
+            }
+        }
+
+        int status = worker_exec(w, command, output, timeout_ms);
+        /* Failures and timeouts reap the worker, its replacement costs a spawn after all */
+        bool completed = w->pid > 0;
+        pthread_mutex_unlock(&w->lock);
+
+        atomic_fetch_add(&stat_pooled_calls, 1);
+        if (completed)
+            atomic_fetch_add(&stat_saved_ns, atomic_load(&saved_per_call_ns));
+        return status;
+    }
+
+    atomic_fetch_add(&stat_fallback_calls, 1);
+    return SHELL_POOL_UNAVAILABLE;
+}
+
+/**
+ * @brief Sends the pool counters ahead of the --stats answer.
+ * @param client Socket returned by control_socket_accept(), left open for the rest of the answer.
+ * @param reset Set to true to clear the counters after they were sent.
+ */
+void shell_pool_stats_report(int client, bool reset) {
+    if (pool_size == 0)
+        return;
+
+    unsigned long long pooled = atomic_load(&stat_pooled_calls);
+    unsigned long long saved_ns = atomic_load(&stat_saved_ns);
+    control_socket_send(client, "Shell pool: %llu pooled, %llu spawned, %llu respawns, %llu timeouts", pooled,
+                        atomic_load(&stat_fallback_calls), atomic_load(&stat_respawns), atomic_load(&stat_timeouts));
+    control_socket_send(client, "Shell pool: ~%.1f ms spawn/exec saved (%.2f ms per call, %.2f ms per spawn)",
+                        saved_ns / 1e6, atomic_load(&saved_per_call_ns) / 1e6, atomic_load(&spawn_cost_ns) / 1e6);
+    control_socket_send(client, "");
+
+    if (reset) {
+        atomic_store(&stat_pooled_calls, 0);
+        atomic_store(&stat_fallback_calls, 0);
+        atomic_store(&stat_respawns, 0);
+        atomic_store(&stat_timeouts, 0);
+        atomic_store(&stat_saved_ns, 0);
+    }
+}
+
+/**
+ * @brief Logs how many commands went through the pool and the fork/exec time this saved.
+ */
+void shell_pool_log_stats(void) {
+    if (pool_size == 0)
+        return;
+
+    log_verbose(LOG_DEBUG, "Shell pool: %llu pooled, %llu spawned, %llu respawns, %llu timeouts, ~%.1f ms spawn/exec saved",
+                atomic_load(&stat_pooled_calls), atomic_load(&stat_fallback_calls), atomic_load(&stat_respawns),
+                atomic_load(&stat_timeouts), atomic_load(&stat_saved_ns) / 1e6);
+}
+
+/**
+ * @brief Stops every pool worker and disables the pool.
+ */
+void shell_pool_shutdown(void) {
+    int size = pool_size;
+    pool_size = 0;
+
+    for (int i = 0; i < size; i++) {
+        pthread_mutex_lock(&pool[i].lock);
+        reap_worker(&pool[i], false);
+        pthread_mutex_unlock(&pool[i].lock);
+    }
+}
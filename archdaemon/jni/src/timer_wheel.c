@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2026-2027 Zexshia
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <AZenith.h>
+#include <sys/timerfd.h>
+
+#define TIMER_TICK_NS (TIMER_TICK_MS * 1000000ULL)
+
+/*
+ * Deferred work of the main thread lives on one hashed timer wheel: timers hang off the slot of
+ * their expiry tick, so scheduling and cancelling are O(1) and an expiry only visits the slots
+ * that passed. A single timerfd in the main poll set is armed for the earliest expiry and left
+ * disarmed while nothing is pending, so an idle daemon is never woken by it. Without a timerfd the
+ * main loop polls with timer_wheel_timeout() instead.
+ * Not thread safe, every function must be called from the main thread.
+ */
+static Timer* slots[TIMER_WHEEL_SLOTS];
+static int timer_fd = -1;
+static int pending = 0;
+static uint64_t wheel_tick = 0;
+static uint64_t armed_tick = 0;
+
+static uint64_t current_tick(void) {
+    return exec_clock_ns() / TIMER_TICK_NS;
+}
+
+/**
+ * @brief Points the timerfd at an absolute tick, 0 disarms it.
+ */
+static void arm_at(uint64_t tick) {
+    if (tick == armed_tick)
+        return;
+    armed_tick = tick;
+    if (timer_fd < 0)
+        return;
+
+    struct itimerspec its = {0};
+    if (tick) {
+        uint64_t ns = tick * TIMER_TICK_NS;
+        its.it_value.tv_sec = ns / 1000000000ULL;
+        its.it_value.tv_nsec = ns % 1000000000ULL;
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * @brief Arms the timerfd for the earliest pending timer.
+ * @note Walks every slot, only done once per dispatch. Schedule and cancel keep the arming
+ * up to date without a walk.
+ */
+static void arm_earliest(void) {
+    uint64_t next = 0;
+    for (int i = 0; i < TIMER_WHEEL_SLOTS && pending > 0; i++) {
+        for (Timer* t = slots[i]; t; t = t->next) {
+            if (!next || t->expires < next)
+                next = t->expires;
+        }
+    }
+    arm_at(next);
+}
+
+static void link_timer(Timer* timer, Timer** head) {
+    timer->next = *head;
+    if (*head)
+        (*head)->pprev = &timer->next;
+    *head = timer;
+    timer->pprev = head;
+}
+
+static void unlink_timer(Timer* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/**
+ * @brief Creates the timerfd that drives the wheel.
+ * @return The timerfd to add to the poll set, or -1 on failure.
+ */
+int timer_wheel_open(void) {
+    wheel_tick = current_tick();
+    armed_tick = 0;
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0)
+        log_zenith(LOG_ERROR, "Failed to create timerfd, timers fall back to poll timeouts: %s", strerror(errno));
+
+    arm_earliest();
+    return timer_fd;
+}
+
+/**
+ * @brief Returns the poll timeout that stands in for the timerfd when it could not be created.
+ * @note Call timer_wheel_dispatch() after every poll in that case.
+ * @return -1 while the timerfd drives the wheel or nothing is pending, otherwise the milliseconds
+ * until the earliest expiry.
+ */
+int timer_wheel_timeout(void) {
+    if (timer_fd >= 0 || !armed_tick)
+        return -1;
+
+    uint64_t now = exec_clock_ns();
+    uint64_t at = armed_tick * TIMER_TICK_NS;
+    return at > now ? (int)((at - now + 999999) / 1000000) : 0;
+}
+
+/**
+ * @brief Runs the callbacks of every expired timer and re-arms the timerfd.
+ * @note Call when the timerfd is readable. Callbacks may schedule or cancel any timer, including
+ * the one that is running.
+ */
+void timer_wheel_dispatch(void) {
+    uint64_t expirations;
+    if (timer_fd >= 0)
+        while (read(timer_fd, &expirations, sizeof(expirations)) > 0)
+            ;
+
+    uint64_t now = current_tick();
+    uint64_t steps = now - wheel_tick;
+    if (steps > TIMER_WHEEL_SLOTS)
+        steps = TIMER_WHEEL_SLOTS;
+
+    /* Expired timers move to a local list first, so a callback cancelling one of them still works */
+    Timer* expired = NULL;
+    Timer** tail = &expired;
+    for (uint64_t i = 1; i <= steps; i++) {
+        Timer** head = &slots[(wheel_tick + i) % TIMER_WHEEL_SLOTS];
+        for (Timer* t = *head; t;) {
+            Timer* next = t->next;
+            if (t->expires <= now) {
+                unlink_timer(t);
+                *tail = t;
+                t->pprev = tail;
+                tail = &t->next;
+            }
+            t = next;
+        }
+    }
+    wheel_tick = now;
+
+    while (expired) {
+        Timer* t = expired;
+        unlink_timer(t);
+        pending--;
+        if (t->fn)
+            t->fn(t->arg);
+    }
+
+    armed_tick = 0;
+    arm_earliest();
+}
+
+/**
+ * @brief Closes the timerfd. Pending timers stay linked but never fire.
+ */
+void timer_wheel_close(void) {
+    if (timer_fd >= 0)
+        close(timer_fd);
+    timer_fd = -1;
+}
+
+/**
+ * @brief Prepares a timer for use.
+ * @param timer Timer to initialize.
+ * @param fn Callback run on expiry, or NULL to only wake the main loop.
+ * @param arg Argument passed to fn.
+ */
+void timer_init(Timer* timer, void (*fn)(void* arg), void* arg) {
+    memset(timer, 0, sizeof(*timer));
+    timer->fn = fn;
+    timer->arg = arg;
+}
+
+/**
+ * @brief Schedules a timer, replacing its previous expiry if it was pending.
+ * @note Timers fire up to one TIMER_TICK_MS late, never early.
+ * @param timer Initialized timer.
+ * @param delay_ms Delay from now in milliseconds.
+ */
+void timer_schedule(Timer* timer, uint32_t delay_ms) {
+    timer_cancel(timer);
+
+    timer->expires = current_tick() + (delay_ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS + 1;
+    link_timer(timer, &slots[timer->expires % TIMER_WHEEL_SLOTS]);
+    pending++;
+
+    if (!armed_tick || timer->expires < armed_tick)
+        arm_at(timer->expires);
+}
+
+/**
+ * @brief Cancels a pending timer, does nothing if it is not pending.
+ * @note The timerfd may stay armed for the cancelled expiry, that wakeup then finds nothing to run.
+ */
+void timer_cancel(Timer* timer) {
+    if (!timer->pprev)
+        return;
+
+    unlink_timer(timer);
+    pending--;
+    if (pending == 0)
+        arm_at(0);
+}
+
+/**
+ * @brief Checks whether a timer is scheduled and has not fired yet.
+ */
+bool timer_pending(const Timer* timer) {
+    return timer->pprev != NULL;
+}
+
+/**
+ * @brief Prepares a retry timer.
+ * @param retry Retry timer to initialize.
+ * @param policy Delays and attempt limit, must outlive the retry timer.
+ * @param fn Callback running the next attempt, or NULL to only wake the main loop.
+ * @param arg Argument passed to fn.
+ */
+void retry_init(RetryTimer* retry, const RetryPolicy* policy, void (*fn)(void* arg), void* arg) {
+    timer_init(&retry->timer, fn, arg);
+    retry->policy = policy;
+    retry->attempt = 0;
+}
+
+/**
+ * @brief Schedules the next attempt of a retry policy.
+ * @param retry Retry timer.
+ * @return The delay of the scheduled attempt in milliseconds, or -1 once every attempt is used
+ * up. The attempt counter then starts over for the next run.
+ */
+int retry_schedule(RetryTimer* retry) {
+    const RetryPolicy* policy = retry->policy;
+    if (retry->attempt >= policy->max_attempts) {
+        retry_reset(retry);
+        return -1;
+    }
+
+    uint32_t delay = policy->delay_ms;
+    for (int i = 0; i < retry->attempt && policy->backoff > 1 && delay < policy->max_delay_ms; i++)
+        delay *= policy->backoff;
+    if (delay > policy->max_delay_ms)
+        delay = policy->max_delay_ms;
+
+    retry->attempt++;
+    timer_schedule(&retry->timer, delay);
+    return (int)delay;
+}
+
+/**
+ * @brief Cancels a pending attempt and starts the attempt count over.
+ */
+void retry_reset(RetryTimer* retry) {
+    timer_cancel(&retry->timer);
+    retry->attempt = 0;
+}
@@ -19,33 +19,71 @@ mod chipsets;
 mod profiles;
 
 use std::env;  use std::path::Path; use std::process::Command;
+use std::io::{BufRead, Write};
 use utils::*;
 use profiles::*;
 
+// Prefix of the status line the daemon waits for after each worker command
+const WORKER_DONE: &str = "__AZPW_DONE ";
+
+// Runs one profile command, returns its exit status or None if the command is unknown
+fn run_command(command: &str) -> Option<i32> {
+    let status = match command {
+        "0" | "initialize" => initialize(),
+        "1" | "performance_profile" => { performance_profile(); 0 }
+        "2" | "balanced_profile" => { balanced_profile(); 0 }
+        "3" | "eco_mode" => { eco_mode(); 0 }
+        "applyfreqbalance" => { applyfreqbalance(); 0 }
+        "applyfreqgame" => { applyfreqgame(); 0 }
+        _ => return None,
+    };
+    Some(status)
+}
+
+// Resident mode started by the daemon: reads one command per stdin line and answers each with a
+// WORKER_DONE line, keeping the discovered frequency tables for the next apply. Children that
+// inherit stdout may print too, the daemon skips anything that is not a status line.
+fn run_worker() {
+    let mut stdout = std::io::stdout();
+
+    for line in std::io::stdin().lock().lines() {
+        let Ok(line) = line else { break };
+        let command = line.trim();
+        if command.is_empty() {
+            continue;
+        }
+
+        reset_log_settings();
+        let status = run_command(command).unwrap_or(2);
+        flush_logs();
+
+        if writeln!(stdout, "{}{}", WORKER_DONE, status).and_then(|_| stdout.flush()).is_err() {
+            break;
+        }
+    }
+}
+
 fn main() {
     unsafe {
         env::set_var("PATH", MY_PATH);
     }
     let args: Vec<String> = env::args().collect();
-    
+    let mut status = 0;
+
     if args.len() > 1 {
-        match args[1].as_str() {
-            "0" | "initialize" => initialize(),
-            "1" | "performance_profile" => performance_profile(),
-            "2" | "balanced_profile" => balanced_profile(),
-            "3" | "eco_mode" => eco_mode(),
-            "applyfreqbalance" => applyfreqbalance(),
-            "applyfreqgame" => applyfreqgame(),
-            _ => {
-                // Batasi eksekusi liar, pastikan argumennya valid sebelum spawn process
-                if Path::new(&args[1]).exists() || args[1].contains('.') {
-                    let _ = Command::new(&args[1])
-                        .args(&args[2..])
-                        .status();
-                }
+        if args[1] == "worker" {
+            run_worker();
+        } else if let Some(code) = run_command(&args[1]) {
+            status = code;
+        } else {
+            // Batasi eksekusi liar, pastikan argumennya valid sebelum spawn process
+            if Path::new(&args[1]).exists() || args[1].contains('.') {
+                let _ = Command::new(&args[1])
+                    .args(&args[2..])
+                    .status();
             }
         }
     }
+    flush_logs();
+    std::process::exit(status);
 }
-
-
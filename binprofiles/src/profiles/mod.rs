@@ -388,7 +388,7 @@ pub fn eco_mode() {
     az_log("ECO Mode applied successfully!");
 }
 
-pub fn initialize() {
+pub fn initialize() -> i32 {
     // 1. Initial kernel panics & sync
     for param in &["panic", "panic_on_warn", "panic_on_oops", "softlockup_panic"] {
         zeshia_def("0", &format!("/proc/sys/kernel/{}", param));
@@ -397,7 +397,9 @@ pub fn initialize() {
 
     // 2. Initialize CPU & I/O & Mali GPU
     init_cpu_governor();
-    init_io_scheduler();
+    if !init_io_scheduler() {
+        return 1;
+    }
     init_maligpu_governor();
 
     // 3. Display / SurfaceFlinger config
@@ -491,4 +493,5 @@ pub fn initialize() {
     let _ = Command::new("sync").status();
     az_log("Initializing Complete");
     dlog("Initializing Complete");
+    0
 }
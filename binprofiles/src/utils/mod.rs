@@ -2,12 +2,39 @@ use std::os::unix::fs::PermissionsExt;
 use std::fs; use std::path::Path; use std::process::Command;
 
 use glob::glob;
-use std::collections::HashSet;
+use std::io::Write;
+use std::os::unix::net::{SocketAddr, UnixDatagram};
+use std::process::Stdio;
+use std::sync::atomic::{AtomicU8, Ordering};
+use std::sync::{Mutex, OnceLock};
+use std::time::Duration;
+#[cfg(target_os = "android")]
+use std::os::android::net::SocketAddrExt;
+#[cfg(target_os = "linux")]
+use std::os::linux::net::SocketAddrExt;
+use std::collections::{HashMap, HashSet};
 
 pub const CONFIG_PATH: &str = "/data/adb/.config/AZenith";
 pub const MY_PATH: &str = "/system/bin:/system/xbin:/data/adb/ap/bin:/data/adb/ksu/bin:/data/adb/magisk:/debug_ramdisk:/sbin:/sbin/su:/su/bin:/su/xbin:/data/data/com.termux/files/usr/bin";
 
 
+// Reads the property area directly, a getprop process per lookup dominated every profile apply
+#[cfg(target_os = "android")]
+pub fn getprop(key: &str) -> String {
+    unsafe extern "C" {
+        fn __system_property_get(name: *const std::ffi::c_char, value: *mut std::ffi::c_char) -> std::ffi::c_int;
+    }
+
+    let Ok(name) = std::ffi::CString::new(key) else {
+        return String::new();
+    };
+    // PROP_VALUE_MAX
+    let mut value = [0u8; 92];
+    let len = unsafe { __system_property_get(name.as_ptr(), value.as_mut_ptr().cast()) };
+    String::from_utf8_lossy(&value[..len.clamp(0, 91) as usize]).trim().to_string()
+}
+
+#[cfg(not(target_os = "android"))]
 pub fn getprop(key: &str) -> String {
     if let Ok(output) = Command::new("getprop").arg(key).output() {
         String::from_utf8_lossy(&output.stdout).trim().to_string()
@@ -17,18 +44,102 @@ pub fn getprop(key: &str) -> String {
 }
 
 
+const LOG_SOCKET: &[u8] = b"azenith.log";
+const LOG_BACKLOG_MAX: usize = 64;
+
+struct PendingLog {
+    verbose: bool,
+    level: u8,
+    tag: &'static str,
+    message: String,
+}
+
+static LOG_CONN: OnceLock<Option<UnixDatagram>> = OnceLock::new();
+static LOG_BACKLOG: Mutex<Vec<PendingLog>> = Mutex::new(Vec::new());
+// 0 until read, then 1 + debugmode; reset per command by the resident worker
+static LOG_DEBUGMODE: AtomicU8 = AtomicU8::new(0);
+
+// Datagram socket of the running daemon, connected once per process
+fn log_socket() -> Option<&'static UnixDatagram> {
+    LOG_CONN
+        .get_or_init(|| {
+            let addr = SocketAddr::from_abstract_name(LOG_SOCKET).ok()?;
+            let sock = UnixDatagram::unbound().ok()?;
+            sock.connect_addr(&addr).ok()?;
+            let _ = sock.set_write_timeout(Some(Duration::from_millis(200)));
+            Some(sock)
+        })
+        .as_ref()
+}
+
+// Sends one line as "<L|V><level>|<tag>|<message>", keeping it for flush_logs() when the daemon is absent
+fn send_log(verbose: bool, level: u8, tag: &'static str, message: &str) {
+    if let Some(sock) = log_socket() {
+        let packet = format!("{}{}|{}|{}", if verbose { 'V' } else { 'L' }, level, tag, message);
+        if sock.send(packet.as_bytes()).is_ok() {
+            return;
+        }
+    }
+
+    let full = {
+        let mut backlog = LOG_BACKLOG.lock().unwrap();
+        backlog.push(PendingLog { verbose, level, tag, message: message.to_string() });
+        backlog.len() >= LOG_BACKLOG_MAX
+    };
+    if full {
+        flush_logs();
+    }
+}
+
+// Hands lines the daemon did not take to one CLI process per tag, fed through stdin
+pub fn flush_logs() {
+    let backlog = std::mem::take(&mut *LOG_BACKLOG.lock().unwrap());
+    let mut done = vec![false; backlog.len()];
+
+    for i in 0..backlog.len() {
+        if done[i] {
+            continue;
+        }
+        let head = &backlog[i];
+        let level = head.level.to_string();
+        let Ok(mut child) = Command::new("sys.azenith-service")
+            .args([if head.verbose { "--verboselog" } else { "--log" }, head.tag, &level, "-"])
+            .stdin(Stdio::piped())
+            .spawn()
+        else {
+            return;
+        };
+
+        if let Some(mut stdin) = child.stdin.take() {
+            for (j, entry) in backlog.iter().enumerate().skip(i) {
+                if entry.verbose == head.verbose && entry.level == head.level && entry.tag == head.tag {
+                    let _ = writeln!(stdin, "{}", entry.message);
+                    done[j] = true;
+                }
+            }
+        }
+        let _ = child.wait();
+    }
+}
+
 pub fn az_log(message: &str) {
-    if get_debugmode() {
-        let _ = Command::new("sys.azenith-service")
-            .args(["--verboselog", "AZLog", "0", message])
-            .status();
+    let mut debugmode = LOG_DEBUGMODE.load(Ordering::Relaxed);
+    if debugmode == 0 {
+        debugmode = 1 + get_debugmode() as u8;
+        LOG_DEBUGMODE.store(debugmode, Ordering::Relaxed);
     }
+    if debugmode == 2 {
+        send_log(true, 0, "AZLog", message);
+    }
+}
+
+// Makes the next az_log() pick up a debugmode toggled since the previous command
+pub fn reset_log_settings() {
+    LOG_DEBUGMODE.store(0, Ordering::Relaxed);
 }
 
 pub fn dlog(message: &str) {
-    let _ = Command::new("sys.azenith-service")
-        .args(["--log", "AZenith_Profiler", "1", message])
-        .status();
+    send_log(false, 1, "AZenith_Profiler", message);
 }
 
 pub fn chmod(path: &str, mode: u32) {
@@ -199,10 +310,8 @@ pub fn setfreqppm() {
             let p_str = path.to_str().unwrap();
             let policy_name = path.file_name().unwrap_or_default().to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
-            let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
+            let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
             let new_max_target = cpu_maxfreq * limiter / 100;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
@@ -244,10 +353,8 @@ pub fn setfreq() {
                 .unwrap_or_default()
                 .to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
-            let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
+            let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
             let new_max_target = cpu_maxfreq * limiter / 100;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
@@ -294,16 +401,14 @@ pub fn setgamefreqppm() {
             let p_str = path.to_str().unwrap();
             let policy_name = path.file_name().unwrap_or_default().to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
 
             let new_midtarget = cpu_maxfreq;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
             let new_midfreq = setfreqs(&avail_file, new_midtarget);
 
             if litemode {
-                let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                    .unwrap_or_default().trim().parse().unwrap_or(0);
+                let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
                 zeshia_def(&format!("{} {}", cluster, new_midfreq), "/proc/ppm/policy/hard_userlimit_max_cpu_freq");
                 zeshia_def(&format!("{} {}", cluster, cpu_minfreq), "/proc/ppm/policy/hard_userlimit_min_cpu_freq");
@@ -332,16 +437,14 @@ pub fn setgamefreq() {
                 .unwrap_or_default()
                 .to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
 
             let new_midtarget = cpu_maxfreq;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
             let new_midfreq = setfreqs(&avail_file, new_midtarget);
 
             if litemode {
-                let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                    .unwrap_or_default().trim().parse().unwrap_or(0);
+                let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
                 // Bugfix: Menulis ke jalur sysfs standar, bukan ke /proc/ppm
                 zeshia(&new_midfreq.to_string(), &format!("{}/scaling_max_freq", p_str));
@@ -371,10 +474,8 @@ pub fn dsetfreqppm() {
     if let Ok(paths) = glob::glob("/sys/devices/system/cpu/cpufreq/policy*") {
         for path in paths.flatten() {
             let p_str = path.to_str().unwrap();
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
-            let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
+            let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
             let new_max_target = cpu_maxfreq * limiter / 100;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
@@ -402,10 +503,8 @@ pub fn dsetfreq() {
     if let Ok(paths) = glob::glob("/sys/devices/system/cpu/*/cpufreq") {
         for path in paths.flatten() {
             let p_str = path.to_str().unwrap();
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
-            let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
+            let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
             let new_max_target = cpu_maxfreq * limiter / 100;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
@@ -444,16 +543,14 @@ pub fn dsetgamefreqppm() {
             let p_str = path.to_str().unwrap();
             let policy_name = path.file_name().unwrap_or_default().to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
 
             let new_midtarget = cpu_maxfreq;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
             let new_midfreq = setfreqs(&avail_file, new_midtarget);
 
             if litemode {
-                let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                    .unwrap_or_default().trim().parse().unwrap_or(0);
+                let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
                 zeshia(&format!("{} {}", cluster, new_midfreq), "/proc/ppm/policy/hard_userlimit_max_cpu_freq");
                 zeshia(&format!("{} {}", cluster, cpu_minfreq), "/proc/ppm/policy/hard_userlimit_min_cpu_freq");
@@ -478,16 +575,14 @@ pub fn dsetgamefreq() {
                 .unwrap_or_default()
                 .to_string_lossy();
 
-            let cpu_maxfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_max_freq", p_str))
-                .unwrap_or_default().trim().parse().unwrap_or(0);
+            let cpu_maxfreq = cpuinfo_freq(p_str, "cpuinfo_max_freq");
 
             let new_midtarget = cpu_maxfreq;
             let avail_file = format!("{}/scaling_available_frequencies", p_str);
             let new_midfreq = setfreqs(&avail_file, new_midtarget);
 
             if litemode {
-                let cpu_minfreq: u64 = fs::read_to_string(format!("{}/cpuinfo_min_freq", p_str))
-                    .unwrap_or_default().trim().parse().unwrap_or(0);
+                let cpu_minfreq = cpuinfo_freq(p_str, "cpuinfo_min_freq");
 
                 zeshia(&new_midfreq.to_string(), &format!("{}/scaling_max_freq", p_str));
                 zeshia(&cpu_minfreq.to_string(), &format!("{}/scaling_min_freq", p_str));
@@ -611,16 +706,33 @@ pub fn get_mtk_gpu_max_freq() -> Option<u64> {
         .max()
 }
 
+// Frequency tables and cpuinfo limits are fixed by the hardware, so each file is parsed once per process
+static FREQ_TABLES: Mutex<Option<HashMap<String, Vec<u64>>>> = Mutex::new(None);
+
 pub fn read_freqs(path: &str) -> Vec<u64> {
+    let mut tables = FREQ_TABLES.lock().unwrap();
+    let tables = tables.get_or_insert_with(HashMap::new);
+    if let Some(freqs) = tables.get(path) {
+        return freqs.clone();
+    }
+
     let mut freqs: Vec<u64> = fs::read_to_string(path)
         .unwrap_or_default()
         .split_whitespace()
         .filter_map(|s: &str| s.parse().ok())
         .collect();
     freqs.sort_unstable();
+    // Missing files stay uncached, the node may show up once its CPU comes online
+    if !freqs.is_empty() {
+        tables.insert(path.to_string(), freqs.clone());
+    }
     freqs
 }
 
+pub fn cpuinfo_freq(policy: &str, file: &str) -> u64 {
+    read_freqs(&format!("{}/{}", policy, file)).first().copied().unwrap_or(0)
+}
+
 pub fn ppm_fix_freq(target_index: &str) {
     let ppm_path = "/proc/ppm/policy/ut_fix_freq_idx";
 
@@ -694,7 +806,7 @@ pub fn init_cpu_governor() {
     dlog("Parsing CPU Governor complete");
 }
 
-pub fn init_io_scheduler() {
+pub fn init_io_scheduler() -> bool {
     let mut io_path = String::new();
     for dev in &["mmcblk0", "mmcblk1", "sda", "sdb", "sdc"] {
         let p = format!("/sys/block/{}/queue", dev);
@@ -707,7 +819,7 @@ pub fn init_io_scheduler() {
 
     if io_path.is_empty() {
         dlog("No valid block device with scheduler found");
-        std::process::exit(1);
+        return false;
     }
 
     let sched_file = format!("{}/scheduler", io_path);
@@ -743,6 +855,7 @@ pub fn init_io_scheduler() {
     }
     
     dlog("Parsing IO Scheduler complete");
+    true
 }
 
 pub fn init_maligpu_governor() {
@@ -45,4 +45,5 @@ fn main() {
             }
         }
     }
+    flush_logs();
 }
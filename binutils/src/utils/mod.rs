@@ -5,6 +5,14 @@ use std::process::Command;
 use std::os::unix::fs::PermissionsExt;
 use std::path::Path;
 use glob::glob;
+use std::io::Write;
+use std::os::unix::net::{SocketAddr, UnixDatagram};
+use std::process::Stdio;
+use std::sync::{Mutex, OnceLock};
+#[cfg(target_os = "android")]
+use std::os::android::net::SocketAddrExt;
+#[cfg(target_os = "linux")]
+use std::os::linux::net::SocketAddrExt;
 
 pub const MY_PATH: &str = "/system/bin:/system/xbin:/data/adb/ap/bin:/data/adb/ksu/bin:/data/adb/magisk:/debug_ramdisk:/sbin:/sbin/su:/su/bin:/su/xbin:/data/data/com.termux/files/usr/bin";
 
@@ -36,18 +44,91 @@ pub fn get_fstrim_state() -> String {
     getprop("persist.sys.azenithconf.fstrim")
 }
 
+const LOG_SOCKET: &[u8] = b"azenith.log";
+const LOG_BACKLOG_MAX: usize = 64;
+
+struct PendingLog {
+    verbose: bool,
+    level: u8,
+    tag: &'static str,
+    message: String,
+}
+
+static LOG_CONN: OnceLock<Option<UnixDatagram>> = OnceLock::new();
+static LOG_BACKLOG: Mutex<Vec<PendingLog>> = Mutex::new(Vec::new());
+static LOG_DEBUGMODE: OnceLock<bool> = OnceLock::new();
+
+// Datagram socket of the running daemon, connected once per process
+fn log_socket() -> Option<&'static UnixDatagram> {
+    LOG_CONN
+        .get_or_init(|| {
+            let addr = SocketAddr::from_abstract_name(LOG_SOCKET).ok()?;
+            let sock = UnixDatagram::unbound().ok()?;
+            sock.connect_addr(&addr).ok()?;
+            let _ = sock.set_write_timeout(Some(Duration::from_millis(200)));
+            Some(sock)
+        })
+        .as_ref()
+}
+
+// Sends one line as "<L|V><level>|<tag>|<message>", keeping it for flush_logs() when the daemon is absent
+fn send_log(verbose: bool, level: u8, tag: &'static str, message: &str) {
+    if let Some(sock) = log_socket() {
+        let packet = format!("{}{}|{}|{}", if verbose { 'V' } else { 'L' }, level, tag, message);
+        if sock.send(packet.as_bytes()).is_ok() {
+            return;
+        }
+    }
+
+    let full = {
+        let mut backlog = LOG_BACKLOG.lock().unwrap();
+        backlog.push(PendingLog { verbose, level, tag, message: message.to_string() });
+        backlog.len() >= LOG_BACKLOG_MAX
+    };
+    if full {
+        flush_logs();
+    }
+}
+
+// Hands lines the daemon did not take to one CLI process per tag, fed through stdin
+pub fn flush_logs() {
+    let backlog = std::mem::take(&mut *LOG_BACKLOG.lock().unwrap());
+    let mut done = vec![false; backlog.len()];
+
+    for i in 0..backlog.len() {
+        if done[i] {
+            continue;
+        }
+        let head = &backlog[i];
+        let level = head.level.to_string();
+        let Ok(mut child) = Command::new("sys.azenith-service")
+            .args([if head.verbose { "--verboselog" } else { "--log" }, head.tag, &level, "-"])
+            .stdin(Stdio::piped())
+            .spawn()
+        else {
+            return;
+        };
+
+        if let Some(mut stdin) = child.stdin.take() {
+            for (j, entry) in backlog.iter().enumerate().skip(i) {
+                if entry.verbose == head.verbose && entry.level == head.level && entry.tag == head.tag {
+                    let _ = writeln!(stdin, "{}", entry.message);
+                    done[j] = true;
+                }
+            }
+        }
+        let _ = child.wait();
+    }
+}
+
 pub fn az_log(message: &str) {
-    if get_debugmode() {
-        let _ = Command::new("sys.azenith-service")
-            .args(["--verboselog", "AZLog", "0", message])
-            .status();
+    if *LOG_DEBUGMODE.get_or_init(get_debugmode) {
+        send_log(true, 0, "AZLog", message);
     }
 }
 
 pub fn dlog(message: &str) {
-    let _ = Command::new("sys.azenith-service")
-        .args(["--log", "AZenith_Utility", "1", message])
-        .status();
+    send_log(false, 1, "AZenith_Utility", message);
 }
 
 pub fn chmod(path: &str, mode: u32) {
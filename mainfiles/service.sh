@@ -49,7 +49,8 @@ nohup app_process -Djava.class.path="$APK_COMP" / \
     --nice-name=sys.azenith-appmonitoring zx.azenith.AppMonitor \
     "$MODULE_CONFIG/app_status" \
     "$MODULE_CONFIG/background_apps" \
-    "$MODULE_CONFIG/java.lock" >"$MODULE_CONFIG/sysmon.log" 2>&1 &
+    "$MODULE_CONFIG/java.lock" \
+    "$MODULE_CONFIG/app_state" >"$MODULE_CONFIG/sysmon.log" 2>&1 &
     
 # Run AZenith service
 sleep 1 && "$BIN_SVC" --run && exec sh "$MODDIR/preferenced-tweaks.sh" &
@@ -25,10 +25,18 @@ import android.os.BatteryManager
 import android.os.Build
 import android.os.IBinder
 import android.os.PowerManager
+import android.system.ErrnoException
+import android.system.Os
+import android.system.OsConstants
 import java.io.File
+import java.io.FileDescriptor
 import java.io.FileOutputStream
+import java.io.RandomAccessFile
+import java.lang.invoke.VarHandle
 import java.lang.reflect.Field
 import java.lang.reflect.Method
+import java.nio.ByteOrder
+import java.nio.MappedByteBuffer
 import java.nio.channels.FileChannel
 import java.nio.channels.FileLock
 import java.nio.file.StandardOpenOption
@@ -44,6 +52,27 @@ object AppMonitor {
     private const val UNKNOWN_APP = "unknown 0 0"
     private const val NONE_APP = "none 0 0"
 
+    // Shared state block layout, keep in sync with AppStateBlock in AZenith.h
+    private const val STATE_SIZE = 4096
+    private const val STATE_MAGIC = 0x54535A41
+    private const val STATE_VERSION = 1
+    private const val OFF_MAGIC = 0
+    private const val OFF_VERSION = 4
+    private const val OFF_SEQ = 8
+    private const val OFF_FOCUSED_PID = 16
+    private const val OFF_FOCUSED_UID = 20
+    private const val OFF_SCREEN_AWAKE = 24
+    private const val OFF_BATTERY_SAVER = 28
+    private const val OFF_ZEN_MODE = 32
+    private const val OFF_BATTERY_LEVEL = 36
+    private const val OFF_IS_CHARGING = 40
+    private const val OFF_REFRESH_RATE = 44
+    private const val OFF_MAX_REFRESH_RATE = 48
+    private const val OFF_FOCUSED_APP = 56
+    private const val LEN_FOCUSED_APP = 128
+    private const val OFF_APP_NAME = 184
+    private const val LEN_APP_NAME = 256
+
     private val FOREGROUND_METHOD_CANDIDATES = listOf(
         "getFocusedRootTaskInfo",
         "getFocusedRootTask",
@@ -84,11 +113,50 @@ object AppMonitor {
     private var outputPath = ""
     private var backgroundOutputPath = ""
     private var lockFilePath: String? = null
+    private var statePath: String? = null
+
+    private var stateBuffer: MappedByteBuffer? = null
+    private var stateSeq = 0
+    private var wakeFd: FileDescriptor? = null
+
+    // Below API 33 the seqlock fences come from sun.misc.Unsafe, which ART keeps for java.util.concurrent
+    private val unsafe: Any? by lazy {
+        runCatching {
+            Class.forName("sun.misc.Unsafe").getDeclaredField("theUnsafe").apply { isAccessible = true }.get(null)
+        }.getOrNull()
+    }
+    private val unsafeStoreFence: Method? by lazy {
+        runCatching { unsafe?.javaClass?.getDeclaredMethod("storeFence") }.getOrNull()
+    }
+
+    private data class AppState(
+        val focusedApp: String,
+        val screenAwake: Int,
+        val batterySaver: Int,
+        val zenMode: Int,
+        val batteryLevel: Int,
+        val isCharging: Int,
+        val appName: String,
+        val refreshRate: Int,
+        val maxRefreshRate: Int
+    ) {
+        fun toText(): String = buildString {
+            appendLine("focused_app $focusedApp")
+            appendLine("screen_awake $screenAwake")
+            appendLine("battery_saver $batterySaver")
+            appendLine("zen_mode $zenMode")
+            appendLine("battery_level $batteryLevel")
+            appendLine("is_charging $isCharging")
+            appendLine("app_name $appName")
+            appendLine("refresh_rate $refreshRate")
+            appendLine("max_refresh_rate $maxRefreshRate")
+        }
+    }
 
     @JvmStatic
     fun main(args: Array<String>) {
         if (args.size < 2) {
-            System.err.println("Usage: <status_output_path> <background_output_path> [lock_file_path]")
+            System.err.println("Usage: <status_output_path> <background_output_path> [lock_file_path] [state_block_path]")
             System.err.println("ERROR: Missing required output paths.")
             return
         }
@@ -100,6 +168,11 @@ object AppMonitor {
             lockFilePath = args[2]
         }
 
+        if (args.size >= 4) {
+            statePath = args[3]
+            openStateBlock()
+        }
+
         bypassHiddenApiRestrictions()
         setupSystemContext()
 
@@ -169,9 +242,16 @@ object AppMonitor {
 
     private fun writeStatus() {
         val focusedApp = waitForValidFocusedApp() ?: return
-        val currentStatus = buildStatus(focusedApp)
+        val state = buildStatus(focusedApp)
+        val currentStatus = state.toText()
         if (currentStatus == lastStatus) return
 
+        // The daemon only reads the block once it listens on the wake FIFO, until then it needs app_status
+        if (stateBuffer != null && publishState(state)) {
+            lastStatus = currentStatus
+            return
+        }
+
         try {
             val file = File(outputPath)
             file.parentFile?.mkdirs()
@@ -276,7 +356,7 @@ object AppMonitor {
     private fun hasMissingPid(appInfo: String): Boolean =
         appInfo != NONE_APP && appInfo.endsWith(" 0 0")
 
-    private fun buildStatus(focusedApp: String): String {
+    private fun buildStatus(focusedApp: String): AppState {
         val screenAwake = if (powerManager?.isInteractive == true) 1 else 0
         val batterySaver = if (powerManager?.isPowerSaveMode == true) 1 else 0
         val zenMode = getZenMode()
@@ -286,17 +366,107 @@ object AppMonitor {
         val appName = getAppName(pkgName)
         val currentRefreshRate = getCurrentRefreshRate()
         val maxRefreshRate = getMaxRefreshRate()
-    
-        return buildString {
-            appendLine("focused_app $focusedApp")
-            appendLine("screen_awake $screenAwake")
-            appendLine("battery_saver $batterySaver")
-            appendLine("zen_mode $zenMode")
-            appendLine("battery_level $batteryLevel")
-            appendLine("is_charging $isCharging")
-            appendLine("app_name $appName")
-            appendLine("refresh_rate $currentRefreshRate")
-            appendLine("max_refresh_rate $maxRefreshRate")
+
+        return AppState(
+            focusedApp, screenAwake, batterySaver, zenMode, batteryLevel,
+            isCharging, appName, currentRefreshRate, maxRefreshRate
+        )
+    }
+
+    /**
+     * Maps the shared state block the daemon reads instead of parsing app_status.
+     * Without a store fence the seqlock is unordered, the text file is used instead.
+     */
+    private fun openStateBlock() {
+        val path = statePath ?: return
+        if (Build.VERSION.SDK_INT < Build.VERSION_CODES.TIRAMISU && unsafeStoreFence == null) {
+            System.err.println("WARN: No store fence available, writing '$outputPath' instead")
+            return
+        }
+        try {
+            RandomAccessFile(path, "rw").use { raf ->
+                raf.setLength(STATE_SIZE.toLong())
+                val buffer = raf.channel.map(FileChannel.MapMode.READ_WRITE, 0, STATE_SIZE.toLong())
+                buffer.order(ByteOrder.LITTLE_ENDIAN)
+
+                stateSeq = buffer.getInt(OFF_SEQ) and 1.inv()
+                buffer.putInt(OFF_SEQ, stateSeq)
+                buffer.putInt(OFF_VERSION, STATE_VERSION)
+                buffer.putInt(OFF_MAGIC, STATE_MAGIC)
+                stateBuffer = buffer
+            }
+        } catch (e: Exception) {
+            System.err.println("WARN: Shared state block unavailable, writing '$outputPath' instead: ${e.message}")
+            stateBuffer = null
+        }
+    }
+
+    private fun putCString(buffer: MappedByteBuffer, offset: Int, capacity: Int, value: String) {
+        val bytes = value.toByteArray(Charsets.UTF_8)
+        val len = minOf(bytes.size, capacity - 1)
+        for (i in 0 until len) buffer.put(offset + i, bytes[i])
+        buffer.put(offset + len, 0)
+    }
+
+    /**
+     * Keeps earlier stores to the state block from being reordered with later ones.
+     * Volatile writes are only release stores on arm64, they cannot order the seqlock.
+     */
+    private fun storeStoreFence() {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            VarHandle.storeStoreFence()
+        } else {
+            unsafeStoreFence?.invoke(unsafe)
+        }
+    }
+
+    /**
+     * Writes the state under the seqlock and rings the daemon's wake FIFO.
+     * @return true if the daemon is listening on the FIFO and reads the block.
+     */
+    private fun publishState(state: AppState): Boolean {
+        val buffer = stateBuffer ?: return false
+        val parts = state.focusedApp.split(" ")
+
+        buffer.putInt(OFF_SEQ, ++stateSeq)
+        storeStoreFence()
+
+        buffer.putInt(OFF_FOCUSED_PID, parts.getOrNull(1)?.toIntOrNull() ?: 0)
+        buffer.putInt(OFF_FOCUSED_UID, parts.getOrNull(2)?.toIntOrNull() ?: 0)
+        buffer.putInt(OFF_SCREEN_AWAKE, state.screenAwake)
+        buffer.putInt(OFF_BATTERY_SAVER, state.batterySaver)
+        buffer.putInt(OFF_ZEN_MODE, state.zenMode)
+        buffer.putInt(OFF_BATTERY_LEVEL, state.batteryLevel)
+        buffer.putInt(OFF_IS_CHARGING, state.isCharging)
+        buffer.putInt(OFF_REFRESH_RATE, state.refreshRate)
+        buffer.putInt(OFF_MAX_REFRESH_RATE, state.maxRefreshRate)
+        putCString(buffer, OFF_FOCUSED_APP, LEN_FOCUSED_APP, parts.getOrElse(0) { "" })
+        putCString(buffer, OFF_APP_NAME, LEN_APP_NAME, state.appName)
+
+        storeStoreFence()
+        buffer.putInt(OFF_SEQ, ++stateSeq)
+
+        return ringDaemon()
+    }
+
+    /**
+     * @return true if the wake reached a daemon reading the FIFO.
+     */
+    private fun ringDaemon(): Boolean {
+        return try {
+            val fd = wakeFd ?: Os.open("$statePath.wake", OsConstants.O_WRONLY or OsConstants.O_NONBLOCK, 0)
+                .also { wakeFd = it }
+            Os.write(fd, byteArrayOf(1), 0, 1)
+            true
+        } catch (e: ErrnoException) {
+            // ENOENT/ENXIO/EPIPE: daemon not listening, EAGAIN: a wake is already pending
+            if (e.errno == OsConstants.EAGAIN) {
+                true
+            } else {
+                wakeFd?.let { runCatching { Os.close(it) } }
+                wakeFd = null
+                false
+            }
         }
     }
 